@@ -35,4 +35,8 @@ main()
 
   layerDraw(&layer0);
 
+  /* without layers: one window per row, clipped at the screen edge */
+  fillCircle(20, screenHeight - 20, circle10.radius, circle10.chords, COLOR_GREEN);
+  drawCircleOutline(screenWidth - 1, 0, 30, 0, COLOR_WHITE);
+
 }
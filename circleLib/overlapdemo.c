@@ -0,0 +1,61 @@
+/** \file overlapdemo.c
+ *  \brief Microbenchmarks for abShapeOverlap, one line per shape pair
+ *
+ *  Each pair is placed just touching (the slowest case for the row
+ *  and pixel scans) and tested OVERLAP_RUNS times; the line shows the
+ *  result and the average time per call in us (Timer1_A, 4us ticks).
+ */
+#include <libTimer.h>
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "abCircle.h"
+
+#define OVERLAP_RUNS 16
+
+AbRect paddle = {abRectGetBounds, abRectCheck, {2, 10}};
+AbRect block = {abRectGetBounds, abRectCheck, {8, 8}};
+AbTriangle ship = {abTriangleGetBounds, abSpanCheck, abTriangleSpan,
+		   {{0,-10}, {8,8}, {-8,8}}};
+AbRArrow arrow = {abRArrowGetBounds, abRArrowCheck, 20};
+
+typedef struct {
+  const char *name;
+  const AbShape *a, *b;
+  Vec2 posA, posB;
+} OverlapPair;
+
+static const OverlapPair pairs[] = {
+  {"rect/rect    ", (AbShape *)&paddle, (AbShape *)&block, {40,40}, {50,45}},
+  {"rect/circle  ", (AbShape *)&paddle, (AbShape *)&circle8, {40,40}, {50,45}},
+  {"circ/circle  ", (AbShape *)&circle8, (AbShape *)&circle14, {40,40}, {60,50}},
+  {"tri/tri span ", (AbShape *)&ship, (AbShape *)&ship, {40,40}, {55,45}},
+  {"tri/circ scan", (AbShape *)&ship, (AbShape *)&circle8, {40,40}, {52,48}},
+  {"arrow/rect px", (AbShape *)&arrow, (AbShape *)&block, {40,40}, {28,52}},
+};
+
+u_int bgColor = COLOR_BLACK;
+
+int
+main()
+{
+  u_char i, n;
+  configureClocks();
+  timeInit();
+  lcd_init();
+  clearScreen(bgColor);
+  drawString5x7(4, 4, "abShapeOverlap us", COLOR_WHITE, bgColor);
+  for (i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+    const OverlapPair *p = &pairs[i];
+    u_int start, ticks;
+    int hit = 0;
+    char buf[6];
+    start = timeNow16();
+    for (n = 0; n < OVERLAP_RUNS; n++)
+      hit = abShapeOverlap(p->a, &p->posA, p->b, &p->posB);
+    ticks = timeElapsed16(start);
+    drawString5x7(4, 20 + i * 10, (char *)p->name, COLOR_GREEN, bgColor);
+    drawString5x7(88, 20 + i * 10, hit ? "y" : "n", COLOR_YELLOW, bgColor);
+    *putDecimal(buf, ticks * 4 / OVERLAP_RUNS, 0, 0) = 0;
+    drawString5x7(100, 20 + i * 10, buf, COLOR_WHITE, bgColor);
+  }
+}
@@ -0,0 +1,56 @@
+/** \file lcdblit.h
+ *  \brief Hand-tuned SPI kernels (lcdblit.s) for streaming pixels
+ *
+ *  All kernels write into the window selected by the previous
+ *  lcd_setArea().  They wait for any pending command byte to leave
+ *  the shifter, raise D/C once, and then keep UCB0TXBUF full by
+ *  polling UCB0TXIFG instead of UCBUSY, so consecutive bytes go out
+ *  back to back.
+ *
+ *  Cycle estimates (MCLK cycles per pixel, from the MSP430x2xx
+ *  family guide instruction timings, CPU side only):
+ *
+ *    path                          C (-Os)   asm
+ *    solid run (fillRectangle)       ~50      ~21
+ *    RAM buffer (per pixel)          ~55      ~26
+ *    1bpp expand (drawChar5x7)       ~90      ~30
+ *
+ *  The C path (lcd_writeColor) calls lcd_writeData twice per pixel;
+ *  each call spins on UCBUSY, so the shifter idles for the whole
+ *  DC-set + TXBUF-write sequence between bytes.  With the default
+ *  SMCLK = DCO/8 the SPI needs 64 MCLK cycles per byte, so both
+ *  paths are SPI-bound: per pixel the C path costs 128 cycles plus
+ *  two inter-byte bubbles (~12 cycles each) while the kernels
+ *  sustain 128.  If SMCLK is raised toward DCO/1 the CPU side
+ *  dominates and the table above applies directly.
+ */
+
+#ifndef lcdblit_included
+#define lcdblit_included
+
+#include "lcdutils.h"
+
+/** Write the same color count times
+ *
+ *  \param colorBGR The color in BGR
+ *  \param count Number of pixels
+ */
+void lcd_fillRun(u_int colorBGR, u_int count);
+
+/** Stream a buffer of pixels
+ *
+ *  \param pixels Colors in BGR
+ *  \param count Number of pixels
+ */
+void lcd_writeBuf(const u_int *pixels, u_int count);
+
+/** Expand a 1bpp row into two colors, least significant bit first
+ *
+ *  \param bits Pixel mask; bit 0 is the leftmost pixel
+ *  \param count Number of pixels (at most 16)
+ *  \param fgColorBGR Color of set bits
+ *  \param bgColorBGR Color of clear bits
+ */
+void lcd_expandBits(u_int bits, u_int count, u_int fgColorBGR, u_int bgColorBGR);
+
+#endif // included
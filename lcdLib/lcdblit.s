@@ -0,0 +1,104 @@
+	.arch msp430g2553
+	.p2align 1,0
+	.text
+
+	;;  SPI pixel kernels, see lcdblit.h
+	;;  args arrive in r12..r15; r11..r15 are scratch (msp430 EABI)
+	;;  UCB0STAT, UCB0TXBUF, IFG2, P1OUT come from the device linker script
+
+	.equ	UCBUSY, 0x01	; UCB0STAT: transfer in progress
+	.equ	TXIFG, 0x08	; IFG2: UCB0TXBUF empty
+	.equ	DCPIN, 0x10	; P1.4: LCD data/command
+
+	;;  wait for UCB0TXBUF to empty (bit 4 + jz 2 cycles)
+	.macro	txwait
+1:	bit.b	#TXIFG, &IFG2
+	jz	1b
+	.endm
+
+	;;  send the low byte of reg (4 cycles)
+	.macro	txbyte reg
+	txwait
+	mov.b	\reg, &UCB0TXBUF
+	.endm
+
+	;;  let a pending command byte finish, then select data
+	.macro	datamode
+1:	bit.b	#UCBUSY, &UCB0STAT
+	jnz	1b
+	bis.b	#DCPIN, &P1OUT
+	.endm
+
+	;; void lcd_fillRun(u_int colorBGR, u_int count)
+	;;   r12 color, r13 count; unrolled two pixels per pass
+	.global lcd_fillRun
+lcd_fillRun:
+	tst	r13
+	jz	9f
+	mov	r12, r14
+	swpb	r14		; r14 low byte = high byte, sent first
+	datamode
+	bit	#1, r13		; odd pixel first
+	jz	2f
+	txbyte	r14
+	txbyte	r12
+2:	clrc
+	rrc	r13		; pairs
+	jz	9f
+3:	txbyte	r14
+	txbyte	r12
+	txbyte	r14
+	txbyte	r12
+	dec	r13
+	jnz	3b
+9:	ret
+
+	;; void lcd_writeBuf(const u_int *pixels, u_int count)
+	;;   r12 pixels, r13 count; unrolled two pixels per pass
+	.global lcd_writeBuf
+lcd_writeBuf:
+	tst	r13
+	jz	9f
+	datamode
+	bit	#1, r13		; odd pixel first
+	jz	2f
+	mov	@r12+, r14
+	swpb	r14
+	txbyte	r14
+	swpb	r14
+	txbyte	r14
+2:	clrc
+	rrc	r13		; pairs
+	jz	9f
+3:	mov	@r12+, r14
+	mov	@r12+, r15
+	swpb	r14
+	txbyte	r14
+	swpb	r14
+	txbyte	r14
+	swpb	r15
+	txbyte	r15
+	swpb	r15
+	txbyte	r15
+	dec	r13
+	jnz	3b
+9:	ret
+
+	;; void lcd_expandBits(u_int bits, u_int count, u_int fg, u_int bg)
+	;;   r12 bits (lsb first), r13 count, r14 fg, r15 bg
+	.global lcd_expandBits
+lcd_expandBits:
+	tst	r13
+	jz	9f
+	datamode
+3:	mov	r15, r11	; assume background
+	rra	r12		; next bit into carry
+	jnc	4f
+	mov	r14, r11
+4:	swpb	r11
+	txbyte	r11
+	swpb	r11
+	txbyte	r11
+	dec	r13
+	jnz	3b
+9:	ret
@@ -2,11 +2,17 @@
  *  \brief A simple demo that draws a string and circle
  */
 
+#include <msp430.h>
 #include <libTimer.h>
 #include "lcdutils.h"
 #include "lcddraw.h"
+#include "smiley.h"
+#include "pacman.h"
 
-/** Initializes everything, clears the screen, draws "hello" and the circle */
+static const u_char zigzag[] = {10,100, 40,150, 70,110, 100,150, 120,100};
+
+/** Initializes everything, clears the screen, draws "hello", a square, lines and sprites,
+ *  then animates one */
 int
 main()
 {
@@ -19,5 +25,18 @@ main()
   drawString5x7(20,20, "hello", COLOR_GREEN, COLOR_RED);
 
   fillRectangle(30,30, 60, 60, COLOR_ORANGE);
-  
+
+  drawLine(0, 0, width-1, height-1, COLOR_WHITE);
+  drawPolyline(zigzag, sizeof(zigzag) / 2, COLOR_YELLOW);
+
+  drawBitmap(100, 10, &smiley);	/* generated from smiley.ppm */
+
+  {				/* pacman.ppm: 4 frames, only changes sent */
+    u_char frame = 0;
+    drawBitmap(100, 40, pacman.first);
+    for (;;) {
+      __delay_cycles(1600000);	/* 100ms per frame at 16MHz */
+      frame = drawAnimStep(100, 40, &pacman, frame);
+    }
+  }
 }
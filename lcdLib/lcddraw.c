@@ -3,6 +3,7 @@
  */
 #include "lcdutils.h"
 #include "lcddraw.h"
+#include "lcdblit.h"
 
 
 /** Draw single pixel at x,row 
@@ -30,11 +31,7 @@ void fillRectangle(u_char colMin, u_char rowMin, u_char width, u_char height,
 {
   u_char colLimit = colMin + width, rowLimit = rowMin + height;
   lcd_setArea(colMin, rowMin, colLimit - 1, rowLimit - 1);
-  u_int total = width * height;
-  u_int c = 0;
-  while ((c++) < total) {
-    lcd_writeColor(colorBGR);
-  }
+  lcd_fillRun(colorBGR, width * height);
 }
 
 /** Clear screen (fill with color)
@@ -54,21 +51,18 @@ void clearScreen(u_int colorBGR)
 void drawChar5x7(u_char rcol, u_char rrow, char c, 
      u_int fgColorBGR, u_int bgColorBGR) 
 {
-  u_char col = 0;
-  u_char row = 0;
+  u_char col;
   u_char bit = 0x01;
-  u_char oc = c - 0x20;
+  const u_char *glyph = font_5x7[c - 0x20];
 
   lcd_setArea(rcol, rrow, rcol + 4, rrow + 7); /* relative to requested col/row */
-  while (row < 8) {
-    while (col < 5) {
-      u_int colorBGR = (font_5x7[oc][col] & bit) ? fgColorBGR : bgColorBGR;
-      lcd_writeColor(colorBGR);
-      col++;
-    }
-    col = 0;
+  while (bit) {			/* 8 rows */
+    u_char rowBits = 0;		/* font is column-major: gather this row */
+    for (col = 0; col < 5; col++)
+      if (glyph[col] & bit)
+	rowBits |= 1 << col;
+    lcd_expandBits(rowBits, 5, fgColorBGR, bgColorBGR);
     bit <<= 1;
-    row++;
   }
 }
 
@@ -94,6 +88,30 @@ void drawString5x7(u_char col, u_char row, char *string,
   }
 }
 
+char *putDecimal(char *p, unsigned long val, u_char width, u_char tenths)
+{
+  char digits[10];
+  u_char n = 0, len;
+  u_int v;
+  while (val > 0xffff) {
+    digits[n++] = '0' + val % 10;
+    val /= 10;
+  }
+  v = val;
+  do {
+    digits[n++] = '0' + v % 10;
+    v /= 10;
+  } while (v || (tenths && n < 2));
+  for (len = tenths ? n + 1 : n; len < width; len++)
+    *p++ = ' ';
+  while (n--) {
+    *p++ = digits[n];
+    if (tenths && n == 1)
+      *p++ = '.';
+  }
+  return p;
+}
+
 
 /** Draw rectangle outline
  *  
@@ -115,3 +133,210 @@ void drawRectOutline(u_char colMin, u_char rowMin, u_char width, u_char height,
   fillRectangle(colMin + width, rowMin, 1, height, colorBGR);
 }
 
+
+/** Bresenham along the major axis, one window per minor-axis step
+ *
+ *  Consecutive pixels that share a row (shallow) or column (steep)
+ *  are one run, sent as a single lcd_setArea and lcd_fillRun.
+ */
+static void
+lineRuns(u_char major, u_char minor, u_char dMajor, u_char dMinor,
+	 signed char sMajor, signed char sMinor, u_char steep, u_int colorBGR)
+{
+  int err = dMajor / 2;
+  u_char runStart = major, n;
+  for (n = dMajor; ; n--) {
+    u_char last = !n;
+    if (!last && (err -= dMinor) >= 0) {
+      major += sMajor;		/* same run */
+      continue;
+    }
+    {
+      u_char lo = (sMajor > 0) ? runStart : major;
+      u_char len = (sMajor > 0) ? major - runStart + 1 : runStart - major + 1;
+      if (steep)
+	fillRectangle(minor, lo, 1, len, colorBGR);
+      else
+	fillRectangle(lo, minor, len, 1, colorBGR);
+    }
+    if (last)
+      break;
+    err += dMajor;
+    minor += sMinor;
+    major += sMajor;
+    runStart = major;
+  }
+}
+
+/** Draw a line from col0,row0 to col1,row1 (both ends included)
+ *  Shallow lines are grouped by row, steep lines by column.
+ */
+void drawLine(u_char col0, u_char row0, u_char col1, u_char row1, u_int colorBGR)
+{
+  int dCol = col1 - col0, dRow = row1 - row0;
+  signed char sCol = 1, sRow = 1;
+  if (dCol < 0) { dCol = -dCol; sCol = -1; }
+  if (dRow < 0) { dRow = -dRow; sRow = -1; }
+  if (dCol >= dRow)		/* shallow: runs along rows */
+    lineRuns(col0, row0, dCol, dRow, sCol, sRow, 0, colorBGR);
+  else				/* steep: runs along columns */
+    lineRuns(row0, col0, dRow, dCol, sRow, sCol, 1, colorBGR);
+}
+
+/** Draw lines joining n points
+ *
+ *  \param points col,row pairs: {col0, row0, col1, row1, ...}
+ *  \param n Number of points
+ *  \param colorBGR Color of lines in BGR
+ */
+void drawPolyline(const u_char *points, u_char n, u_int colorBGR)
+{
+  for (; n > 1; n--, points += 2)
+    drawLine(points[0], points[1], points[2], points[3], colorBGR);
+}
+
+/** Half chord widths of a circle's rows for d = 0, 1, ... radius,
+ *  from a chord table if there is one, else by the midpoint rule
+ *  x*x + d*d <= r*r + r, kept up with additions only.
+ */
+typedef struct {
+  const u_char *chords;
+  u_char d, x;
+  int err;			/* r*r + r - x*x - d*d */
+} ChordWalk;
+
+static void
+chordWalkInit(ChordWalk *w, const u_char *chords, u_char radius)
+{
+  w->chords = chords;
+  w->d = 0;
+  w->x = radius;
+  w->err = radius;
+}
+
+/* half width at d, then d++ */
+static u_char
+chordWalkNext(ChordWalk *w)
+{
+  if (w->chords) {		/* widest column reaching d, as in abCircleCheck */
+    while (w->chords[w->x] < w->d)
+      w->x--;
+  } else {
+    while (w->err < 0) {
+      w->err += 2 * w->x - 1;
+      w->x--;
+    }
+    w->err -= 2 * w->d + 1;
+  }
+  w->d++;
+  return w->x;
+}
+
+/* One window per run, clipped to the screen */
+static void
+clippedRun(int colMin, int colMax, int row, u_int colorBGR)
+{
+  if (row < 0 || row >= screenHeight)
+    return;
+  if (colMin < 0)
+    colMin = 0;
+  if (colMax >= screenWidth)
+    colMax = screenWidth - 1;
+  if (colMin <= colMax)
+    fillRectangle(colMin, row, colMax - colMin + 1, 1, colorBGR);
+}
+
+/* Columns lo..hi from col, both sides, on the rows d above and below row */
+static void
+circleRows(int col, int row, u_char d, u_char lo, u_char hi, u_int colorBGR)
+{
+  signed char side;
+  for (side = -1; side <= 1; side += 2) {
+    int r = row + side * d;
+    if (lo == 0) {
+      clippedRun(col - hi, col + hi, r, colorBGR);
+    } else {
+      clippedRun(col - hi, col - lo, r, colorBGR);
+      clippedRun(col + lo, col + hi, r, colorBGR);
+    }
+    if (d == 0)
+      break;
+  }
+}
+
+/** Fill a circle centered at col,row
+ *  One window per row; rows and columns off screen are clipped.
+ */
+void fillCircle(int col, int row, u_char radius, const u_char *chords, u_int colorBGR)
+{
+  ChordWalk w;
+  u_char d;
+  chordWalkInit(&w, chords, radius);
+  for (d = 0; d <= radius; d++)
+    circleRows(col, row, d, 0, chordWalkNext(&w), colorBGR);
+}
+
+/** Draw a circle's outline centered at col,row
+ *  Each row spans from its own half width in to just past the next
+ *  row's, so steep sides have no gaps.
+ */
+void drawCircleOutline(int col, int row, u_char radius, const u_char *chords, u_int colorBGR)
+{
+  ChordWalk w;
+  u_char d, half, next = 0;
+  chordWalkInit(&w, chords, radius);
+  half = chordWalkNext(&w);
+  for (d = 0; d <= radius; d++) {
+    u_char lo = 0;
+    if (d < radius) {
+      next = chordWalkNext(&w);
+      lo = (next < half) ? next + 1 : half;
+    }
+    circleRows(col, row, d, lo, half, colorBGR);
+    half = next;
+  }
+}
+
+/** Draw bitmap with its top-left corner at col,row
+ *  Rows are contiguous in data, so runs are read straight through;
+ *  runs of the same color (split at 16 pixels) go out as one fill.
+ */
+void drawBitmap(u_char col, u_char row, const Bitmap *bitmap)
+{
+  const u_char *run = bitmap->data;
+  u_int pixels = bitmap->width * bitmap->height; /* not yet decoded */
+  u_int color = 0, count = 0;			 /* not yet sent */
+  lcd_setArea(col, row, col + bitmap->width - 1, row + bitmap->height - 1);
+  while (pixels) {
+    u_char length = BITMAP_RUN_LENGTH(*run);
+    u_int runColor = bitmap->palette[BITMAP_RUN_INDEX(*run)];
+    if (runColor != color && count) {
+      lcd_fillRun(color, count);
+      count = 0;
+    }
+    color = runColor;
+    count += length;
+    pixels -= length;
+    run++;
+  }
+  lcd_fillRun(color, count);
+}
+
+/** Advance an animation drawn at col,row from frame to the next
+ */
+u_char drawAnimStep(u_char col, u_char row, const AnimBitmap *anim, u_char frame)
+{
+  const u_int *palette = anim->first->palette;
+  const u_char *p = anim->deltas + anim->deltaStart[frame];
+  const u_char *end = anim->deltas + anim->deltaStart[frame + 1];
+  while (p < end) {
+    u_char c = col + p[1], pixels = p[2];
+    lcd_setArea(c, row + p[0], c + pixels - 1, row + p[0]);
+    for (p += 3; pixels; p++) {
+      u_char length = BITMAP_RUN_LENGTH(*p);
+      lcd_fillRun(palette[BITMAP_RUN_INDEX(*p)], length);
+      pixels -= length;
+    }
+  }
+  return (frame + 1 < anim->frames) ? frame + 1 : 0;
+}
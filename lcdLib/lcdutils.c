@@ -134,11 +134,29 @@ void lcd_setArea(u_char colStart, u_char rowStart, u_char colEnd, u_char rowEnd)
 /** Initialize onboard LCD */
 void lcd_init() 
 {
-  setUpSPIforLCD();
-  _writeCommand(SWRESET);  /**< software reset */
-  _delay(20);
-  _writeCommand(SLEEPOUT); /**< exit sleep */
-  _delay(20);
+  u_int ms;
+  while ((ms = lcd_initStep()))
+    _delay(ms / 10);
+}
+
+/** One step of lcd_init; the panel needs time after reset and wake */
+u_int lcd_initStep()
+{
+  static u_char step;
+  switch (step++) {
+  case 0:
+    setUpSPIforLCD();
+    _writeCommand(SWRESET);  /**< software reset */
+    return 200;
+  case 1:
+    _writeCommand(SLEEPOUT); /**< exit sleep */
+    return 200;
+  case 2:
+    break;
+  default:
+    step = 3;			/**< already done */
+    return 0;
+  }
   _writeCommand(COLMOD);   /**< Set Color Format 16bit */
   lcd_writeData(0x05);
   _writeCommand(DISPON);   /**< display ON */
@@ -157,5 +175,6 @@ void lcd_init()
   default:
     lcd_writeData(0xC8);
   }
+  return 0;
 }
 
@@ -41,6 +41,13 @@ extern const unsigned int colors[43];
 /** Initialize the onboard LCD */
 void lcd_init();
 
+/** Initialize the onboard LCD a step at a time, so the caller can do
+ *  other work during the panel's reset and wake-up delays
+ *
+ *  \return Milliseconds to wait before the next call, 0 when done
+ */
+u_int lcd_initStep();
+
 /** Set area to draw to
  *  
  *  \param colStart Start column of the area
@@ -0,0 +1,260 @@
+///////////////////////////////////////////
+// makeBitmap: convert a PPM image into a Bitmap (see lcddraw.h)
+//
+//   makeBitmap [-frames n] name image.ppm [transparent]
+//
+// writes name.c and name.h defining "const Bitmap name".  transparent
+// is an RGB color in hex (e.g. ff00ff) that AbBitmap leaves out.
+// The image may use at most 16 colors.  PNGs can be converted first,
+// e.g. with netpbm: pngtopnm image.png > image.ppm
+//
+// With -frames, image is a strip of n frames side by side and name
+// is an AnimBitmap: frame 0 as a Bitmap, then for each step (the last
+// one back to frame 0) only the pixels that change.
+///////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_COLORS 16
+#define MAX_RUN 16
+#define WINDOW_BYTES 11		/* SPI bytes to open an lcd window */
+#define MERGE_GAP (WINDOW_BYTES / 2) /* unchanged pixels cheaper to resend */
+
+static unsigned int palette[MAX_COLORS];	/* RGB */
+static int colors;
+static unsigned char *pixels;	/* [height][width] palette indices */
+static int width, height;
+
+/* next number in a PPM header, skipping whitespace and comments */
+static int
+ppmNumber(FILE *fp)
+{
+  int c, n;
+  while ((c = getc(fp)) != EOF) {
+    if (c == '#')
+      while ((c = getc(fp)) != EOF && c != '\n')
+	;
+    else if (c > ' ')
+      break;
+  }
+  ungetc(c, fp);
+  if (fscanf(fp, "%d", &n) != 1) {
+    fprintf(stderr, "makeBitmap: bad PPM header\n");
+    exit(1);
+  }
+  return n;
+}
+
+static int
+paletteIndex(unsigned int rgb)
+{
+  int i;
+  for (i = 0; i < colors; i++)
+    if (palette[i] == rgb)
+      return i;
+  if (colors == MAX_COLORS) {
+    fprintf(stderr, "makeBitmap: more than %d colors (reduce with pnmquant 16)\n", MAX_COLORS);
+    exit(1);
+  }
+  palette[colors] = rgb;
+  return colors++;
+}
+
+static unsigned int
+rgb2bgr565(unsigned int rgb)
+{
+  unsigned int r = rgb >> 16, g = (rgb >> 8) & 0xff, b = rgb & 0xff;
+  return ((b >> 3) << 11) | ((g >> 2) << 5) | (r >> 3);
+}
+
+/* Write pixels p[0..n) as runs; returns the number of run bytes */
+static unsigned int
+writeRuns(FILE *fp, const unsigned char *p, int n)
+{
+  int col, runs = 0;
+  for (col = 0; col < n; ) {
+    int length = 1;
+    while (col + length < n && length < MAX_RUN && p[col + length] == p[col])
+      length++;
+    fprintf(fp, "0x%02x,", (length - 1) << 4 | p[col]);
+    col += length;
+    runs++;
+  }
+  return runs;
+}
+
+/* Bitmap of the frame starting at column left, frameWidth wide */
+static unsigned int
+writeBitmap(FILE *fp, const char *name, const char *storage, int left, int frameWidth,
+	    int transparent)
+{
+  unsigned int *rowStart = malloc(height * sizeof *rowStart), runs = 0;
+  int row;
+
+  fprintf(fp, "static const u_char %sData[] = {\n", name);
+  for (row = 0; row < height; row++) {	/* runs never cross rows */
+    rowStart[row] = runs;
+    fprintf(fp, "  ");
+    runs += writeRuns(fp, &pixels[row * width + left], frameWidth);
+    fprintf(fp, " // row %d\n", row);
+  }
+  fprintf(fp, "};\n\n");
+
+  fprintf(fp, "static const u_int %sRowStart[%d] = {", name, height);
+  for (row = 0; row < height; row++)
+    fprintf(fp, "%s%s%u", row ? "," : "", (row % 12) ? " " : "\n  ", rowStart[row]);
+  fprintf(fp, "\n};\n\n");
+
+  fprintf(fp, "%sconst Bitmap %s = {\n  %d, %d, %sPalette, %sRowStart, %sData, 0x%02x\n};\n\n",
+	  storage, name, frameWidth, height, name, name, name, transparent);
+  free(rowStart);
+  return runs;
+}
+
+/** Changes from frame a to frame b as records of
+ *    row, col, pixels, runs covering those pixels (in frame b)
+ *  Changed pixels less than MERGE_GAP apart share a record, since
+ *  resending them costs less than opening another window.
+ *
+ *  \return SPI bytes to play the step (windows + 2 per pixel)
+ */
+static unsigned int
+writeDelta(FILE *fp, int a, int b, int frameWidth, unsigned int *bytes)
+{
+  unsigned int spi = 0;
+  int row, col;
+  fprintf(fp, "  /* %d -> %d */\n", a, b);
+  for (row = 0; row < height; row++) {
+    const unsigned char *pa = &pixels[row * width + a * frameWidth];
+    const unsigned char *pb = &pixels[row * width + b * frameWidth];
+    for (col = 0; col < frameWidth; col++) {
+      int end, last;
+      if (pa[col] == pb[col])
+	continue;
+      for (last = end = col; end < frameWidth && end - last <= MERGE_GAP; end++)
+	if (pa[end] != pb[end])
+	  last = end;
+      fprintf(fp, "  %d, %d, %d, ", row, col, last - col + 1);
+      *bytes += 3 + writeRuns(fp, &pb[col], last - col + 1);
+      fprintf(fp, "\n");
+      spi += WINDOW_BYTES + 2 * (last - col + 1);
+      col = last;
+    }
+  }
+  return spi;
+}
+
+int
+main(int argc, char **argv)
+{
+  FILE *in, *fp;
+  char filename[100], frameName[100];
+  const char *name;
+  int frames = 1, frameWidth, maxval, binary, row, col, i, transparent = 0xff;
+  unsigned int runs, deltaBytes = 0, deltaSpi = 0, *deltaStart;
+
+  if (argc > 2 && !strcmp(argv[1], "-frames")) {
+    frames = atoi(argv[2]);
+    argc -= 2; argv += 2;
+  }
+  if (argc < 3 || argc > 4 || frames < 1) {
+    fprintf(stderr, "usage: makeBitmap [-frames n] name image.ppm [transparent rrggbb]\n");
+    return 1;
+  }
+  name = argv[1];
+  if (!(in = fopen(argv[2], "rb"))) {
+    perror(argv[2]);
+    return 1;
+  }
+  if (getc(in) != 'P' || ((binary = getc(in)) != '6' && binary != '3')) {
+    fprintf(stderr, "makeBitmap: %s is not a P3 or P6 PPM\n", argv[2]);
+    return 1;
+  }
+  binary = binary == '6';
+  width = ppmNumber(in); height = ppmNumber(in); maxval = ppmNumber(in);
+  frameWidth = width / frames;
+  if (width % frames) {
+    fprintf(stderr, "makeBitmap: width %d is not %d frames\n", width, frames);
+    return 1;
+  }
+  if (frameWidth < 1 || frameWidth > 255 || height < 1 || height > 255) {
+    fprintf(stderr, "makeBitmap: %dx%d does not fit (at most 255x255)\n", frameWidth, height);
+    return 1;
+  }
+  getc(in);			/* single whitespace before raster */
+
+  pixels = malloc(width * height);
+  for (row = 0; row < height; row++)
+    for (col = 0; col < width; col++) {
+      unsigned int c[3];
+      for (i = 0; i < 3; i++) {
+	if (binary && maxval > 255) {	/* big endian; getc order matters */
+	  unsigned int high = getc(in);
+	  c[i] = high << 8 | getc(in);
+	} else if (binary)
+	  c[i] = getc(in);
+	else if (fscanf(in, "%u", &c[i]) != 1)
+	  c[i] = 0;
+	c[i] = c[i] * 255 / maxval;
+      }
+      pixels[row * width + col] = paletteIndex(c[0] << 16 | c[1] << 8 | c[2]);
+    }
+  fclose(in);
+  if (argc == 4) {
+    unsigned int rgb = strtoul(argv[3], 0, 16);
+    for (i = 0; i < colors; i++)
+      if (palette[i] == rgb)
+	transparent = i;
+  }
+
+  sprintf(filename, "%s.c", name);
+  fp = fopen(filename, "w");
+  fprintf(fp, "// Automatically generated by makeBitmap from %s\n", argv[2]);
+  fprintf(fp, "#include \"lcdutils.h\"\n#include \"lcddraw.h\"\n\n");
+  sprintf(frameName, (frames > 1) ? "%sFrame0" : "%s", name);
+  fprintf(fp, "static const u_int %sPalette[%d] = {", frameName, colors);
+  for (col = 0; col < colors; col++)
+    fprintf(fp, "%s0x%04x", col ? ", " : "", rgb2bgr565(palette[col]));
+  fprintf(fp, "};\n\n");
+  runs = writeBitmap(fp, frameName, (frames > 1) ? "static " : "", 0, frameWidth, transparent);
+
+  if (frames > 1) {
+    deltaStart = malloc((frames + 1) * sizeof *deltaStart);
+    fprintf(fp, "static const u_char %sDeltas[] = {\n", name);
+    for (i = 0; i < frames; i++) {
+      deltaStart[i] = deltaBytes;
+      deltaSpi += writeDelta(fp, i, (i + 1) % frames, frameWidth, &deltaBytes);
+    }
+    deltaStart[frames] = deltaBytes;
+    fprintf(fp, "};\n\n");
+    fprintf(fp, "static const u_int %sDeltaStart[%d] = {", name, frames + 1);
+    for (i = 0; i <= frames; i++)
+      fprintf(fp, "%s%u", i ? ", " : "", deltaStart[i]);
+    fprintf(fp, "};\n\n");
+    fprintf(fp, "const AnimBitmap %s = {\n  &%s, %d, %sDeltaStart, %sDeltas\n};\n",
+	    name, frameName, frames, name, name);
+  }
+  fclose(fp);
+
+  sprintf(filename, "%s.h", name);
+  fp = fopen(filename, "w");
+  fprintf(fp, "// Automatically generated by makeBitmap from %s\n", argv[2]);
+  fprintf(fp, "#ifndef %s_included\n#define %s_included\n\n", name, name);
+  fprintf(fp, "#include \"lcddraw.h\"\n\n");
+  if (frames > 1)
+    fprintf(fp, "extern const AnimBitmap %s;\t/* %d frames %dx%d, %d colors, %u bytes of deltas */\n\n",
+	    name, frames, frameWidth, height, colors, deltaBytes);
+  else
+    fprintf(fp, "extern const Bitmap %s;\t/* %dx%d, %d colors, %u bytes of runs */\n\n",
+	    name, frameWidth, height, colors, runs);
+  fprintf(fp, "#endif // included\n");
+  fclose(fp);
+
+  fprintf(stderr, "%s: %dx%d, %d colors, %u run bytes (%d bytes unpacked)\n",
+	  name, frameWidth, height, colors, runs, 2 * frameWidth * height);
+  if (frames > 1)
+    fprintf(stderr, "%s: %d frames, %u delta bytes; SPI bytes per step %u vs %d redrawn\n",
+	    name, frames, deltaBytes, deltaSpi / frames, WINDOW_BYTES + 2 * frameWidth * height);
+  return 0;
+}
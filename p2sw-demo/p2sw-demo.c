@@ -1,5 +1,8 @@
 /** \file lcddemo.c
  *  \brief A simple demo that draws a string and circle
+ *  Also shows Port_2 interrupts per press, averaged over all presses
+ *  so far.  Build with "make DEBOUNCE=1" to compare against the
+ *  debounced driver.
  */
 
 #include <libTimer.h>
@@ -7,25 +10,59 @@
 #include <lcddraw.h>
 #include <p2switches.h>
 
+#ifdef DEBOUNCE
+/** Samples the switches at the watchdog interval (~244Hz), once per
+ *  interval covered, so held times stay in 4.1ms ticks at any speed
+ */
+void
+__interrupt_vec(WDT_VECTOR) WDT()
+{
+  u_char i;
+  for (i = wdtIntervals(); i; i--)
+    p2sw_tick();
+}
+#endif
 
 /** Initializes everything, clears the screen, draws "hello" and the circle */
 void main()
 {
+  u_int presses = 0;
   configureClocks();
   lcd_init();
+#ifdef DEBOUNCE
+  p2sw_init_debounced(15);
+  enableWDTInterrupts();
+#else
   p2sw_init(15);
+#endif
   or_sr(0x8);			/* GIE (enable interrupts) */
   u_char width = screenWidth, height = screenHeight;
 
   clearScreen(COLOR_BLUE);
 
   drawString5x7(10,10, "switches:", COLOR_GREEN, COLOR_BLUE);
+  drawString5x7(10,50, "irqs:", COLOR_GREEN, COLOR_BLUE);
+  drawString5x7(10,60, "presses:", COLOR_GREEN, COLOR_BLUE);
+  drawString5x7(10,70, "irqs/press:", COLOR_GREEN, COLOR_BLUE);
   while (1) {
     u_int switches = p2sw_read(), i;
-    char str[5];
+    P2swEvent ev;
+    char str[6];
     for (i = 0; i < 4; i++)
       str[i] = (switches & (1<<i)) ? '-' : '0'+i;
     str[4] = 0;
     drawString5x7(30,30, str, COLOR_GREEN, COLOR_BLUE);
+
+    while (p2sw_getEvent(&ev))	/* count switches that went down */
+      if (ev.kind == P2SW_EDGE)
+	for (i = 0; i < 4; i++)
+	  if ((ev.changed & ~ev.state) & (1<<i))
+	    presses++;
+    *putDecimal(str, p2sw_irqCount, 5, 0) = 0; /* padded over the old value */
+    drawString5x7(80,50, str, COLOR_GREEN, COLOR_BLUE);
+    *putDecimal(str, presses, 5, 0) = 0;
+    drawString5x7(80,60, str, COLOR_GREEN, COLOR_BLUE);
+    *putDecimal(str, presses ? p2sw_irqCount / presses : 0, 5, 0) = 0;
+    drawString5x7(80,70, str, COLOR_GREEN, COLOR_BLUE);
   } 
 }
@@ -5,13 +5,42 @@ static unsigned char switch_mask;
 static unsigned char switches_last_reported;
 static unsigned char switches_current;
 
+/* single producer (Port_2, p2sw_tick) single consumer (p2sw_getEvent)
+   ring.  head and tail run freely and are masked to index it, so all
+   P2SW_QUEUE_SIZE slots hold events.  An event is 4 bytes: its kind
+   is kept apart, two bits per slot in queue_kinds. */
+static struct {
+  unsigned char state, changed;
+  unsigned int time;
+} queue[P2SW_QUEUE_SIZE];
+static unsigned char queue_kinds;
+static volatile unsigned char queue_head; /* written only by producers */
+static volatile unsigned char queue_tail; /* written only by p2sw_getEvent */
+unsigned char p2sw_dropped;
+
+/* debouncer state, touched only by Port_2 and p2sw_tick */
+static unsigned char debounced;	/* p2sw_init_debounced() was used */
+static volatile unsigned char bouncing; /* interrupts off, tick samples */
+static unsigned char count0, count1; /* vertical counters: bit n of each
+					is switch n's 2-bit count */
+static unsigned char repeating;	/* P2SW_LONG already sent for this hold */
+static unsigned char held_ticks;
+unsigned char p2sw_longTicks = 122, p2sw_repeatTicks = 24; /* 0.5s, 0.1s */
+unsigned int p2sw_irqCount;
+
+static void
+switch_set_sense(unsigned char state)
+{
+  /* update switch interrupt to detect changes from state */
+  P2IES |= state;		/* if switch up, sense down */
+  P2IES &= (state | ~switch_mask); /* if switch down, sense up */
+}
+
 static void
 switch_update_interrupt_sense()
 {
   switches_current = P2IN & switch_mask;
-  /* update switch interrupt to detect changes from current buttons */
-  P2IES |= (switches_current);  /* if switch up, sense down */
-  P2IES &= (switches_current | ~switch_mask); /* if switch down, sense up */
+  switch_set_sense(switches_current);
 }
 
 void 
@@ -26,6 +55,13 @@ p2sw_init(unsigned char mask)
   switch_update_interrupt_sense();
 }
 
+void
+p2sw_init_debounced(unsigned char mask)
+{
+  debounced = 1;
+  p2sw_init(mask);
+}
+
 /* Returns a word where:
  * the high-order byte is the buttons that have changed,
  * the low-order byte is the current state of the buttons
@@ -37,11 +73,110 @@ p2sw_read() {
   return switches_current | (sw_changed << 8);
 }
 
+unsigned char
+p2sw_pending()
+{
+  return queue_head - queue_tail;
+}
+
+int
+p2sw_getEvent(P2swEvent *ev)
+{
+  unsigned char tail = queue_tail, slot = tail & (P2SW_QUEUE_SIZE - 1);
+  if (tail == queue_head)
+    return 0;
+  ev->state = queue[slot].state;
+  ev->changed = queue[slot].changed;
+  ev->kind = (queue_kinds >> (2 * slot)) & 3;
+  ev->time = queue[slot].time;
+  queue_tail = tail + 1;	/* slot is free again */
+  return 1;
+}
+
+static void
+queue_push(unsigned char kind, unsigned char state, unsigned char changed,
+	   unsigned int time)
+{
+  unsigned char head = queue_head, slot = head & (P2SW_QUEUE_SIZE - 1);
+  if ((unsigned char)(head - queue_tail) == P2SW_QUEUE_SIZE) { /* full */
+    p2sw_dropped++;
+    return;
+  }
+  queue[slot].state = state;
+  queue[slot].changed = changed;
+  queue_kinds = (queue_kinds & ~(3 << (2 * slot))) | (kind << (2 * slot));
+  queue[slot].time = time;
+  queue_head = head + 1;	/* publish after the slot is written */
+}
+
+int
+p2sw_busy()
+{
+  return bouncing || (debounced && (~switches_current & switch_mask));
+}
+
+/* A switch's level must differ from switches_current for four
+ * consecutive samples before it toggles; all switches are counted at
+ * once, a bit of count1:count0 per switch.
+ */
+int
+p2sw_tick()
+{
+  unsigned char sample, delta, toggle, held;
+  int queued = 0;
+  if (bouncing) {
+    sample = P2IN & switch_mask;
+    delta = sample ^ switches_current;
+    count1 = (count1 ^ count0) & delta; /* count up where different, */
+    count0 = ~count0 & delta;	       /* else reset to 0 */
+    toggle = delta & ~(count0 | count1); /* wrapped: 4th sample */
+    if (toggle) {
+      switches_current ^= toggle;
+      queue_push(P2SW_EDGE, switches_current, toggle, TA1R);
+      queued = 1;
+      held_ticks = repeating = 0;
+    }
+    if (!(delta & ~toggle)) {	/* stable: rearm the edge interrupt */
+      switch_set_sense(switches_current);
+      P2IFG &= ~switch_mask;
+      if ((P2IN & switch_mask) == switches_current) { /* no edge missed */
+	bouncing = 0;
+	P2IE |= switch_mask;
+      }
+    }
+  }
+  held = ~switches_current & switch_mask;
+  if (debounced && held &&
+      ++held_ticks == (repeating ? p2sw_repeatTicks : p2sw_longTicks)) {
+    queue_push(repeating ? P2SW_REPEAT : P2SW_LONG, switches_current, held, TA1R);
+    queued = 1;
+    held_ticks = 0;
+    repeating = 1;
+  }
+  return queued;
+}
+
 /* Switch on P2 (S1) */
 void
 __interrupt_vec(PORT2_VECTOR) Port_2(){
-  if (P2IFG & switch_mask) {  /* did a button cause this interrupt? */
+  unsigned char edges = P2IFG & switch_mask;
+  if (edges) {  /* did a button cause this interrupt? */
+    unsigned char previous = switches_current, changed, pulsed;
+    unsigned int time = TA1R;
+    p2sw_irqCount++;
     P2IFG &= ~switch_mask;	/* clear pending sw interrupts */
-    switch_update_interrupt_sense();
+    if (debounced) {		/* quiet until p2sw_tick sees it settle */
+      P2IE &= ~switch_mask;
+      bouncing = 1;		/* and wake so p2sw_tick gets a clock */
+    } else {
+      switch_update_interrupt_sense();
+      changed = previous ^ switches_current;
+      pulsed = edges & ~changed; /* went and came back before we looked */
+      if (pulsed)
+	queue_push(P2SW_EDGE, previous ^ pulsed, pulsed, time);
+      if (changed | pulsed)
+	queue_push(P2SW_EDGE, switches_current, changed | pulsed, time);
+    }
+    __bic_SR_register_on_exit(LPM4_bits); /* let the main loop see it */
   }
 }
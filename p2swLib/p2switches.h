@@ -6,4 +6,58 @@
 unsigned int p2sw_read();
 void p2sw_init(unsigned char mask);
 
+/* Like p2sw_init(), but the first edge turns the switch interrupt off
+ * and p2sw_tick() samples the switches until they have been stable
+ * for four ticks.  Also reports long presses and auto-repeat.
+ */
+void p2sw_init_debounced(unsigned char mask);
+
+/* Call from a periodic interrupt (e.g. every watchdog tick) after
+ * p2sw_init_debounced().  Returns 1 if it queued an event.
+ */
+int p2sw_tick();
+
+/* Nonzero while p2sw_tick() has work to do: a switch is bouncing or
+ * held down.  Otherwise the tick may be stopped until the next edge.
+ */
+int p2sw_busy();
+
+/* Ticks a switch must be held for P2SW_LONG, then between P2SW_REPEATs
+ * (defaults suit the ~244Hz watchdog interval)
+ */
+extern unsigned char p2sw_longTicks, p2sw_repeatTicks;
+
+/* Port_2 interrupts taken */
+extern unsigned int p2sw_irqCount;
+
+#define P2SW_EDGE 0		/* switches in changed went up or down */
+#define P2SW_LONG 1		/* switches in changed held p2sw_longTicks */
+#define P2SW_REPEAT 2		/* ...and every p2sw_repeatTicks after that */
+
+/** A switch edge, queued by the Port_2 interrupt handler
+ *  (or by p2sw_tick() when debounced)
+ */
+typedef struct {
+  unsigned char state;		/* switch levels after the edge (0 = down) */
+  unsigned char changed;	/* switches that changed */
+  unsigned char kind;		/* P2SW_EDGE, P2SW_LONG or P2SW_REPEAT */
+  unsigned int time;		/* TA1R when the edge was handled */
+} P2swEvent;
+
+#define P2SW_QUEUE_SIZE 4	/* power of two, at most 4 (queue_kinds) */
+
+/* Removes the oldest queued edge.
+ * Returns 1 if *ev was filled, 0 if the queue is empty.
+ * Presses shorter than the interrupt latency are queued as a down
+ * and an up event with the same time.  The handler wakes the CPU
+ * when it queues an event.
+ */
+int p2sw_getEvent(P2swEvent *ev);
+
+/* Number of queued events */
+unsigned char p2sw_pending();
+
+/* Events lost because the queue was full */
+extern unsigned char p2sw_dropped;
+
 #endif // included
@@ -1,13 +1,8 @@
 #include <msp430.h>
 #include "buzzer.h"
+#include "sound.h"
 #include <libTimer.h>
 
-static unsigned int period = 1000;
-static signed int rate = 200;
-
-#define MIN_PERIOD 1000
-#define MAX_PERIOD 4000
-
 #define PORT2_CONFIGURE P2SEL2
 #define P2_PIN_BEHAVIOR P2SEL
 #define P2_INPUT_OUTPUT P2DIR
@@ -30,30 +25,26 @@ void buzzer_init() {
     P2DIR = BIT6;        /* enable output to speaker (P2.6) */
 
 }
-    void upBuzz() {
-        buzzer_set_period(period ^ 1000);
-    }
-
-    void downBuzz() {
-        buzzer_set_period(period ^ 1000);
-    }
-
-    void hitBuzz() {
-        buzzer_set_period(period ^ 1000);
-    }
-
-    void loseBuzz() {
-        buzzer_set_period(period ^ 1000);
-    }
-
-/*
-buzzer_set_period: mov r12, &CCR0
-            mov &CCRO, r14
-            rrc r14
-            mov r14 &CCR1
-            RET
-*/
+/* The game only asks for effects; sound.c plays them */
+void upBuzz() {
+    sound_play(SOUND_UP);
+}
+
+void downBuzz() {
+    sound_play(SOUND_DOWN);
+}
+
+void hitBuzz() {
+    sound_play(SOUND_HIT);
+}
+
+void loseBuzz() {
+    sound_play(SOUND_LOSE);
+}
+
+/* Square wave with a period of cycles 2MHz cycles, or silence if 0 */
 void buzzer_set_period(short cycles) {
-    CCR0 = cycles -1000;
+    cycles >>= clockSmclkShift;	/* SMCLK is 1MHz at CLOCK_SLOW */
+    CCR0 = cycles;
     CCR1 = cycles >> 1;		/* one half cycle */
 }
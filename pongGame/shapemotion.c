@@ -7,40 +7,75 @@
 #include <p2switches.h>
 #include <shape.h>
 #include <abCircle.h>
+#include <pt.h>
 #include "buzzer.h"
+#include "sound.h"
 
 #define GREEN_LED BIT6
 #define WIDTH 2
 #define LENGTH 10
-static int increment;
-static int onesPlace = 0;
-static int tensPlace = 0;
-static int hundredsPlace = 0;
-//definitions for score
-static char score1[3];
-static char score2[3];
+#define WIN_POINTS 5
+
+/** Game events: set by interrupts and tasks, cleared by the task that
+ *  waits for them
+ */
+#define EV_POINT1 1             /**< player 1 (left) scored */
+#define EV_POINT2 2             /**< player 2 (right) scored */
+#define EV_SERVE 4              /**< put the ball back in play */
+#define EV_GAMEOVER 8
+#define EV_PRESS 16             /**< a switch went down */
+static volatile u_char gameEvents = EV_SERVE;
+
+static u_char points[2];        /**< player 1, player 2 */
+static char scoreText[4] = "0:0";
  u_int bgColor = COLOR_BLUE;     /**< The background color */
 
 
 
 
 
-AbRect rectanglePanel = {
+const AbRect rectanglePanel = {
         abRectGetBounds, abRectCheck, {WIDTH, LENGTH}
 };
 
 
-AbRectOutline fieldOutline = {	/* playing field */
+const AbRectOutline fieldOutline = {	/* playing field */
   abRectOutlineGetBounds, abRectOutlineCheck,
   {screenWidth/2-10, screenHeight/2-10}
 };
 
+const AbText scoreLabel = { abTextGetBounds, abTextCheck, "SCORE" };
+const AbText scoreValue = { abTextGetBounds, abTextCheck, scoreText };
+const AbText gameOverText = { abTextGetBounds, abTextCheck, "GAME OVER" };
+
+ Layer gameOverLayer = {	/**< linked in only while the game is over */
+         (AbShape *)&gameOverText,
+         {37, 40},				    /**< top left */
+         {0,0}, {0,0},				    /* last & next pos */
+         COLOR_RED,
+         0,
+ };
+
+ Layer scoreLayerL5 = {		/**< Layer with the score digits */
+         (AbShape *)&scoreValue,
+         {70, 0},				    /**< top left */
+         {0,0}, {0,0},				    /* last & next pos */
+         COLOR_WHITE,
+         0,
+ };
+ Layer labelLayerL4 = {		/**< Layer with "SCORE" */
+         (AbShape *)&scoreLabel,
+         {35, 0},				    /**< top left */
+         {0,0}, {0,0},				    /* last & next pos */
+         COLOR_GOLD,
+         &scoreLayerL5,
+ };
  Layer BallLayerL2 = {		/** Layer with a violet Ball */
          (AbShape *)&circle8,
          {(screenWidth/2)+10, (screenHeight/2)+5}, /**< bit below & right of center */
          {0,0}, {0,0},				    /* last & next pos */
          COLOR_VIOLET,
-         0,
+         &labelLayerL4,
  };
  Layer fieldLayerL3 = {		/* playing field as a layer */
          (AbShape *) &fieldOutline,
@@ -67,76 +102,11 @@ Layer rightPadL0 = {		/**< Layer with right pad */
   &leftPadL1,
 };
 
-/** Moving Layer
- *  Linked list of layer references
- *  Velocity represents one iteration of change (direction & magnitude)
- */
-typedef struct MovLayer_s {
-  Layer *layer;
-  Vec2 velocity;
-  struct MovLayer_s *next;
-} MovLayer;
-
-MovLayer ml3 = { &BallLayerL2, {1,1}, 0 };//layer for ball
+MovLayer ml3 = { &BallLayerL2, {0,0}, 0 };//layer for ball, served by serveTask
 MovLayer ml1 = { &leftPadL1, {0,1}, &ml3 };//left paddle
 MovLayer ml0 = { &rightPadL0, {0,1}, &ml1 };//right paddle
 
 
-//moves layers in game
-void movLayerDraw(MovLayer *movLayers, Layer *layers)
-{
-  int row, col;
-  MovLayer *movLayer;
-
-  and_sr(~8);			/**< disable interrupts (GIE off) */
-  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
-    Layer *l = movLayer->layer;
-    l->posLast = l->pos;
-    l->pos = l->posNext;
-  }
-  or_sr(8);			/**< disable interrupts (GIE on) */
-
-
-  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
-    Region bounds;
-    layerGetBounds(movLayer->layer, &bounds);
-    lcd_setArea(bounds.topLeft.axes[0], bounds.topLeft.axes[1],
-		bounds.botRight.axes[0], bounds.botRight.axes[1]);
-    for (row = bounds.topLeft.axes[1]; row <= bounds.botRight.axes[1]; row++) {
-      for (col = bounds.topLeft.axes[0]; col <= bounds.botRight.axes[0]; col++) {
-	Vec2 pixelPos = {col, row};
-	u_int color = bgColor;
-	Layer *probeLayer;
-	for (probeLayer = layers; probeLayer;
-	     probeLayer = probeLayer->next) { /* probe all layers, in order */
-	  if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
-	    color = probeLayer->color;
-	    break;
-	  } /* if probe check */
-	} // for checking all layes at col, row
-	lcd_writeColor(color);
-      } // for col
-    } // for row
-  } // for moving layer being updated
-}
-
-//score point func
-void scorePoint(int player) {
-
-    if (onesPlace < 9 && increment > 0) {
-        onesPlace++;
-
-        if (player == 1) {
-            score1[0] = '0' + 1;
-        } else {
-            score2[2] = '0' + 1;
-        }
-        increment = 0;
-
-    }
-}
-
-
 //Region fence = {{10,30}, {SHORT_EDGE_PIXELS-10, LONG_EDGE_PIXELS-10}}; /**< Create a fence region */
 
 /** Advances a moving shape within a fence
@@ -144,6 +114,12 @@ void scorePoint(int player) {
  *  \param ml The moving shape to be advanced
  *  \param fence The region which will serve as a boundary for ml
  */
+/** True if pad touches a ball at ballPos (pixel exact) */
+static int padReturns(const Layer *pad, const Vec2 *ballPos)
+{
+    return abShapeOverlap(pad->abShape, &pad->posNext, BallLayerL2.abShape, ballPos);
+}
+
 void mlAdvance(MovLayer *ml, Region *fence)
 {
     Vec2 newPos;
@@ -153,32 +129,22 @@ void mlAdvance(MovLayer *ml, Region *fence)
         vec2Add(&newPos, &ml->layer->posNext, &ml->velocity);
         abShapeGetBounds(ml->layer->abShape, &newPos, &shapeBoundary);
         for (axis = 0; axis < 2; axis ++) {
-
-            if (ml->layer->abShape == ml3.layer->abShape) {
-
-                if ( rightPadL0.pos.axes[axis] < BallLayerL2.pos.axes[axis]) {
-                    int velocity = ml->velocity.axes[axis] = -ml->velocity.axes[axis];
-                    newPos.axes[axis] += (2 * velocity);
-                    hitBuzz();
-                    increment = '0' + 1; //player one score
-                    scorePoint(increment);
-                }
-
-
-                 /*if (abShapeCheck(ml1.layer->abShape, leftPadL1.pos.axes[axis], BallLayerL2.radius)) {
-                    int velocity = ml->velocity.axes[axis] = -ml->velocity.axes[axis];
-                    newPos.axes[axis] += (2 * velocity);
-                    hitBuzz();
-                    increment = '0' + 2; //p2 score
-                    scorePoint(increment);
-                }
-                  */
-            }
-
               if ((shapeBoundary.topLeft.axes[axis] < fence->topLeft.axes[axis]) ||
                 (shapeBoundary.botRight.axes[axis] > fence->botRight.axes[axis])) {
-                int velocity = ml->velocity.axes[axis] = -ml->velocity.axes[axis];
+                int velocity;
+                if (ml == &ml3 && axis == 0) {  // ball reached a goal line
+                    int left = newPos.axes[0] < screenWidth/2;
+                    if (!padReturns(left ? &leftPadL1 : &rightPadL0, &newPos)) {
+                        gameEvents |= left ? EV_POINT2 : EV_POINT1;
+                        ml->velocity = vec2Zero;        // scoreTask takes over
+                        newPos = ml->layer->posNext;
+                        break;
+                    }
+                }
+                velocity = ml->velocity.axes[axis] = -ml->velocity.axes[axis];
                 newPos.axes[axis] += (2 * velocity);
+                if (ml == &ml3)
+                    hitBuzz();
             }    /**< if outside of fence */
 
         } /**< for axis */
@@ -216,88 +182,267 @@ void switchHandler(u_int switches){
         }
 
 
- int redrawScreen = 1;           /**< Boolean for whether screen needs to be redrawn */
 Region fieldFence;		/**< fence around playing field  */
+RedrawJob redraw;		/**< full redraws, a tile row per pass */
+#define REDRAW_ROWS TILE_SIZE
+
+/* Game scripts, run as protothreads from the main loop.  They wait on
+ * gameEvents and on time (polled each pass, so to the nearest physics
+ * tick); statics keep their state across waits.
+ */
+static Pt serveThread, scoreThread, gameOverThread;
+
+static void scoreShow() {
+    layerMarkDirty(&scoreLayerL5);
+    scoreText[0] = '0' + points[0];
+    scoreText[2] = '0' + points[1];
+}
+
+/** Centers the ball, waits a second, and serves it, alternating sides */
+static int serveTask(Pt *pt) {
+    static signed char direction = 1;
+    PT_BEGIN(pt);
+    for (;;) {
+        PT_WAIT_EVENT(pt, gameEvents, EV_SERVE);
+        gameEvents &= ~EV_SERVE;
+        BallLayerL2.posNext = screenCenter;
+        ml3.velocity = vec2Zero;
+        PT_WAIT_TICKS(pt, TIME_MS(1000));
+        ml3.velocity.axes[0] = direction;
+        ml3.velocity.axes[1] = 1;
+        direction = -direction;
+    }
+    PT_END(pt);
+}
+
+/** Counts a point and flashes the score while the next serve waits */
+static int scoreTask(Pt *pt) {
+    static u_char flash;
+    PT_BEGIN(pt);
+    for (;;) {
+        PT_WAIT_EVENT(pt, gameEvents, EV_POINT1 | EV_POINT2);
+        if (gameEvents & EV_POINT1)
+            points[0]++;
+        if (gameEvents & EV_POINT2)
+            points[1]++;
+        gameEvents &= ~(EV_POINT1 | EV_POINT2);
+        loseBuzz();
+        scoreShow();
+        if (points[0] >= WIN_POINTS || points[1] >= WIN_POINTS)
+            gameEvents |= EV_GAMEOVER;
+        else
+            gameEvents |= EV_SERVE;
+        for (flash = 0; flash < 6; flash++) {
+            scoreLayerL5.color = (flash & 1) ? COLOR_WHITE : COLOR_RED;
+            layerMarkDirty(&scoreLayerL5);
+            PT_WAIT_TICKS(pt, TIME_MS(150));
+        }
+    }
+    PT_END(pt);
+}
+
+/** Shows GAME OVER until a switch is pressed, then starts a new game */
+static int gameOverTask(Pt *pt) {
+    PT_BEGIN(pt);
+    for (;;) {
+        PT_WAIT_EVENT(pt, gameEvents, EV_GAMEOVER);
+        gameEvents &= ~EV_GAMEOVER;
+        gameOverLayer.next = scoreLayerL5.next;
+        scoreLayerL5.next = &gameOverLayer;
+        layerMarkDirty(&gameOverLayer);
+        PT_WAIT_TICKS(pt, TIME_MS(1000)); // ignore presses meant for a paddle
+        gameEvents &= ~EV_PRESS;
+        PT_WAIT_EVENT(pt, gameEvents, EV_PRESS);
+        gameEvents &= ~EV_PRESS;
+        scoreLayerL5.next = gameOverLayer.next;
+        redrawJobStart(&redraw);      // fresh screen, without a stall
+        points[0] = points[1] = 0;
+        scoreShow();
+        gameEvents |= EV_SERVE;
+    }
+    PT_END(pt);
+}
+
+#define PHYSICS_TICKS TIME_US(61440) /**< 15 of the old watchdog intervals */
+#define SWITCH_TICKS TIME_US(4096) /**< debounce sample period */
+
+/** Physics steps due: counted by the tick, taken by the main loop, so
+ *  that collision tests run on the main stack and not in the interrupt
+ */
+static volatile u_char physicsDue;
+
+/** Asks the main loop for a physics step and a frame */
+static int physicsTick(SoftTimer *t) {
+    physicsDue++;
+    return 1;
+}
+
+/** Runs the debouncer only while a switch is bouncing or held */
+static int switchTick(SoftTimer *t) {
+    int queued = p2sw_tick();
+    if (!p2sw_busy())
+        softTimerStop(t);
+    return queued;                // wake the main loop for the event
+}
+
+SoftTimer physicsTimer = {0, 0, physicsTick};
+SoftTimer switchTimer = {0, 0, switchTick};
+
+#ifdef POWER_STATS
+static unsigned long bootTicks;	/**< time from reset to the first frame */
+
+/** Bottom row, once a second: w interrupts per second, a percentage
+ *  of the time the CPU was awake, and the MCU's estimated energy per
+ *  frame in uJ.  The split by cause is in powerCounts.
+ */
+static char powerText[24];
+AbText powerValue = { abTextGetBounds, abTextCheck, powerText };
+Layer powerLayerL6 = {
+        (AbShape *)&powerValue,
+        {0, screenHeight-8},			    /**< bottom left */
+        {0,0}, {0,0},				    /* last & next pos */
+        COLOR_WHITE,
+        0,
+};
+
+static volatile u_char statsDue;
+static int statsTick(SoftTimer *t) {
+    statsDue = 1;
+    return 1;
+}
+SoftTimer statsTimer = {0, 0, statsTick};
+
+static unsigned long statsEnergy; // nJ, summed over statsFrames
+static u_int statsFrames;
+
+static void statsShow() {
+    static unsigned long lastWakeups, lastActive;
+    unsigned long wakeups = 0, active = 0;
+    char *p = powerText;
+    u_char i;
+    and_sr(~8);                   // counters are updated by interrupts
+    for (i = 0; i < POWER_CAUSES; i++) {
+        if (i != POWER_MAIN)
+            wakeups += powerCounts[i].count;
+        active += powerCounts[i].ticks;
+    }
+    or_sr(8);
+    layerMarkDirty(&powerLayerL6); // old text
+    *p++ = 'w'; p = putDecimal(p, wakeups - lastWakeups, 0, 0);
+    *p++ = ' '; *p++ = 'a';
+    p = putDecimal(p, (active - lastActive) * 100 / TIME_TICKS_PER_SEC, 0, 0);
+    *p++ = '%'; *p++ = ' ';
+    p = putDecimal(p, statsFrames ? statsEnergy / statsFrames / 1000 : 0, 0, 0);
+    *p++ = 'u'; *p++ = 'J'; *p = 0;
+    layerMarkDirty(&powerLayerL6); // new text
+    lastWakeups = wakeups;
+    lastActive = active;
+    statsEnergy = statsFrames = 0;
+}
+
+/** Bottom row until the first statistics: boot time in ms */
+static void bootShow() {
+    char *p = powerText;
+    *p++ = 'b'; *p++ = 'o'; *p++ = 'o'; *p++ = 't'; *p++ = ' ';
+    p = putDecimal(p, bootTicks / TIME_MS(1), 0, 0);
+    *p++ = 'm'; *p++ = 's'; *p = 0;
+    layerMarkDirty(&powerLayerL6);
+}
+#endif // POWER_STATS
 /** Initializes everything, enables interrupts and green LED,
  *  and handles the rendering for the screen
  */
 void main() {
+  u_int lcdWait;
+  unsigned long lcdReady;
   P1DIR |= GREEN_LED;        /**< Green led on when CPU on */
   P1OUT |= GREEN_LED;
 
   configureClocks();
-  lcd_init();
-  p2sw_init(15);
+  timeInit();                  /**< boot time is measured from here */
+  lcdWait = lcd_initStep();    /**< the panel resets while we set up */
+  lcdReady = timeDeadline(TIME_MS(lcdWait));
+  p2sw_init_debounced(15);
     shapeInit();
     buzzer_init();
 
 
+#ifdef POWER_STATS
+  scoreLayerL5.next = &powerLayerL6;
+#endif
   layerInit(&rightPadL0);
-  layerDraw(&rightPadL0);
 
 
   layerGetBounds(&fieldLayerL3, &fieldFence);
 
 
 
-  enableWDTInterrupts();      /**< enable periodic interrupt */
+  softTimerStart(&physicsTimer, PHYSICS_TICKS, PHYSICS_TICKS);
+#ifdef POWER_STATS
+  softTimerStart(&statsTimer, TIME_MS(1000), TIME_MS(1000));
+#endif
   or_sr(0x8);                  /**< GIE (enable interrupts) */
 
-  u_int j;
-
-  for (j = 0; j < 3; j++) {//fill in 000 for score
-      score1[j] = '0';
-      score2[j] = '0';
+  while (lcdWait) {            /**< sleep out the rest of each panel delay */
+      long left = lcdReady - timeNow();
+      if (left > 0)
+          timeDelay(left);
+      lcdWait = lcd_initStep();
+      lcdReady = timeDeadline(TIME_MS(lcdWait));
   }
+  layerDrawFirst(&rightPadL0); /**< field covers the screen: one full pass */
+#ifdef POWER_STATS
+  bootTicks = timeNow();
+  bootShow();
+#endif
 
-
-  score1[3] = 0;
-  score2[3] = 0;
-
-    u_int switches;
   for (;;) {
-      switches = p2sw_read();
-    while (!redrawScreen) { /**< Pause CPU if screen doesn't need updating */
+    P2swEvent ev;
+    u_char steps;
+    and_sr(~8);               /**< flags are tested with interrupts off... */
+    while (!physicsDue && !p2sw_pending() && !redraw.active) { /**< Pause CPU until a tick or switch edge */
+      if (p2sw_busy() && !switchTimer.active) // an edge: sample until settled
+        softTimerStart(&switchTimer, SWITCH_TICKS, SWITCH_TICKS);
       P1OUT &= ~GREEN_LED;    /**< Green led off witHo CPU */
-     or_sr(0x10);          /**< CPU OFF */
+      powerSleep();           /**< ...and enabled as it sleeps (deepest LPM the timers allow) */
+      and_sr(~8);
     }
 
 
     P1OUT |= GREEN_LED;       // Green led on when CPU on
-
-
-      switchHandler(switches);
-
-      drawString5x7(45, 0, "SCORE", COLOR_GOLD, COLOR_BLACK); //shows score
-      drawString5x7(50,3,score1,COLOR_BLACK, COLOR_WHITE);
-
-      redrawScreen =0;
-      movLayerDraw(&ml0, &rightPadL0); // Move ball
+    steps = physicsDue;
+    physicsDue = 0;
+    or_sr(8);
+
+      while (p2sw_getEvent(&ev))    // every edge, even between frames
+          if (ev.kind == P2SW_EDGE) {
+              switchHandler(ev.state);
+              if (ev.changed & ~ev.state)
+                  gameEvents |= EV_PRESS;
+          }
+      serveTask(&serveThread);
+      scoreTask(&scoreThread);
+      gameOverTask(&gameOverThread);
+
+      clockSetSpeed(CLOCK_FAST);    // render at 16MHz...
+
+#ifdef POWER_STATS
+      if (statsDue) {
+          statsDue = 0;
+          statsShow();
+      }
+#endif
+      while (steps--)
+          mlAdvance(&ml0, &fieldFence); // moves the paddles and ball, detects collisions
+      movLayerCommit(&ml0);         // marks tiles the paddles and ball touched
+      frameFlush(&rightPadL0);      // redraws only those tiles
+      redrawJobStep(&redraw, &rightPadL0, REDRAW_ROWS);
+#ifdef POWER_STATS
+      statsEnergy += powerFrame();
+      statsFrames++;
+#endif
+      clockSetSpeed(CLOCK_SLOW);    // ...and sleep and handle input at 1MHz
 
   }//end for
 
  }
-
-
-
-
-/** Watchdog timer interrupt handler. 15 interrupts/sec */
-void wdt_c_handler() {
-
-   static short count = 0;
-   P1OUT |= GREEN_LED;              /**< Green LED on when cpu on */
-   count++;
-   if (count == 15) {
-     mlAdvance(&ml0, &fieldFence); //detect any collisions
-
-       if (p2sw_read()){
-           redrawScreen = 1;
-       }
-       count = 0;
-   }
-    P1OUT &= ~GREEN_LED;    /**< Green LED off when cpu off */
- }
-
-
-
-
@@ -0,0 +1,104 @@
+#include <msp430.h>
+#include <libTimer.h>
+#include "buzzer.h"
+#include "sound.h"
+
+#define SOUND_TICK TIME_US(4096)	/* one note tick */
+
+/** One note: a buzzer period in SMCLK cycles (2MHz / frequency, 0 for
+ *  a rest) held for ticks note ticks.  Sequences end with ticks == 0.
+ */
+typedef struct {
+  unsigned int period;
+  unsigned char ticks;
+} Note;
+
+typedef struct {
+  const Note *notes;
+  unsigned char priority;	/**< higher preempts lower */
+} Effect;
+
+#define C4 7634
+#define G4 5102
+#define C5 3822
+#define G5 2551
+#define C6 1911
+#define REST 0
+
+static const Note upNotes[] = {{C5, 6}, {G5, 6}, {0, 0}};
+static const Note downNotes[] = {{G5, 6}, {C5, 6}, {0, 0}};
+static const Note hitNotes[] = {{C6, 10}, {0, 0}};
+static const Note loseNotes[] = {
+  {C5, 30}, {REST, 8}, {G4, 30}, {REST, 8}, {C4, 60}, {0, 0}
+};
+
+static const Effect effects[SOUND_COUNT] = {
+  {0, 0},			/* SOUND_NONE */
+  {upNotes, 1},
+  {downNotes, 1},
+  {hitNotes, 2},
+  {loseNotes, 3},
+};
+
+/* bit per requested id, set by sound_play() with interrupts off */
+static volatile unsigned char requests;
+
+static const Note *note;	/* playing, or 0 when silent */
+static unsigned char noteLeft;	/* ticks left in *note */
+static unsigned char playing;	/* id of the playing effect */
+
+static int soundTick(SoftTimer *t);
+static SoftTimer soundTimer = {0, 0, soundTick}; /* runs only while busy */
+
+/* soundTick() only stops its timer when it sees no request, and the
+ * request bit is set before the timer is checked, so none are lost.
+ */
+void
+sound_play(unsigned char id)
+{
+  unsigned int sr = get_sr();
+  and_sr(~8);			/* a variable shift is not one bis */
+  requests |= 1 << id;
+  if (sr & 8)			/* only if they were on: may be in an isr */
+    or_sr(8);
+  if (!soundTimer.active)
+    softTimerStart(&soundTimer, 0, SOUND_TICK);
+}
+
+static void
+noteStart(const Note *n)
+{
+  note = n;
+  noteLeft = n->ticks;
+  buzzer_set_period(n->period);
+}
+
+static int
+soundTick(SoftTimer *t)
+{
+  unsigned char pending = requests, id, best = SOUND_NONE;
+  if (pending) {
+    requests = 0;		/* main can't run until we return */
+    for (id = 1; id < SOUND_COUNT; id++)
+      if ((pending & (1 << id)) &&
+	  (best == SOUND_NONE || effects[id].priority >= effects[best].priority))
+	best = id;
+    if (best != SOUND_NONE &&
+	(!note || effects[best].priority >= effects[playing].priority)) {
+      playing = best;
+      noteStart(effects[best].notes);
+      return 0;
+    }
+  }
+  if (note && --noteLeft == 0) {
+    if (note[1].ticks)
+      noteStart(note + 1);
+    else {			/* end of the effect */
+      note = 0;
+      buzzer_set_period(0);
+    }
+  }
+  if (!note && !requests)
+    softTimerStop(t);		/* idle: stop waking up */
+  return 0;
+}
@@ -0,0 +1,22 @@
+#ifndef sound_included
+#define sound_included
+
+/** Sound effects, played from note tables in flash */
+enum {
+  SOUND_NONE,
+  SOUND_UP,			/**< paddle up */
+  SOUND_DOWN,			/**< paddle down */
+  SOUND_HIT,			/**< ball hit a wall */
+  SOUND_LOSE,			/**< point scored */
+  SOUND_COUNT
+};
+
+/** Requests an effect; returns at once.  Safe from interrupt handlers.
+ *  The effect starts at the next note tick (a soft timer that runs
+ *  only while there is sound) if its priority is at least that of
+ *  the effect playing, else it is dropped.  The buzzer is silenced
+ *  at the end of each effect.
+ */
+void sound_play(unsigned char id);
+
+#endif // included
@@ -4,7 +4,8 @@
  *  One layer contains a rectangle and the other a circle.
  *  While the CPU is running the green LED is on, and
  *  when the screen does not need to be redrawn the CPU
- *  is turned off along with the green LED.
+ *  is turned off along with the green LED.  The red square turns white
+ *  while it overlaps the orange circle (found while compositing).
  */
 #include <stdio.h>
 #include <stdlib.h>
@@ -93,59 +94,13 @@ Layer layer0 = {		/**< Layer with an orange circle */
   &layer1,
 };
 
-/** Moving Layer
- *  Linked list of layer references
- *  Velocity represents one iteration of change (direction & magnitude)
- */
-typedef struct MovLayer_s {
-  Layer *layer;
-  Vec2 velocity;
-  struct MovLayer_s *next;
-} MovLayer;
+Layer *const touchLayers[] = {&layer0, &layer1}; /**< circle and square */
 
 /* initial value of {0,0} will be overwritten */
 MovLayer ml3 = { &layer3, {1,1}, 0 }; /**< not all layers move */
 MovLayer ml1 = { &layer1, {1,2}, &ml3 }; 
 MovLayer ml0 = { &layer0, {2,1}, &ml1 }; 
 
-void movLayerDraw(MovLayer *movLayers, Layer *layers)
-{
-  int row, col;
-  MovLayer *movLayer;
-
-  and_sr(~8);			/**< disable interrupts (GIE off) */
-  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
-    Layer *l = movLayer->layer;
-    l->posLast = l->pos;
-    l->pos = l->posNext;
-  }
-  or_sr(8);			/**< disable interrupts (GIE on) */
-
-
-  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
-    Region bounds;
-    layerGetBounds(movLayer->layer, &bounds);
-    lcd_setArea(bounds.topLeft.axes[0], bounds.topLeft.axes[1], 
-		bounds.botRight.axes[0], bounds.botRight.axes[1]);
-    for (row = bounds.topLeft.axes[1]; row <= bounds.botRight.axes[1]; row++) {
-      for (col = bounds.topLeft.axes[0]; col <= bounds.botRight.axes[0]; col++) {
-	Vec2 pixelPos = {col, row};
-	u_int color = bgColor;
-	Layer *probeLayer;
-	for (probeLayer = layers; probeLayer;probeLayer = probeLayer->next) { /* probe all layers, in order */
-	  if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
-	    color = probeLayer->color;
-	    break; 
-	  } /* if probe check */
-	} // for checking all layers at col, row
-	lcd_writeColor(color); 
-      } // for col
-    } // for row
-  } // for moving layer being updated
-}	  
-
-
-
 //Region fence = {{10,30}, {SHORT_EDGE_PIXELS-10, LONG_EDGE_PIXELS-10}}; /**< Create a fence region */
 
 /** Advances a moving shape within a fence
@@ -172,11 +127,127 @@ void mlAdvance(MovLayer *ml, Region *fence)
   } /**< for ml */
 }
 
+#ifdef STRESS_N
+/** Stress mode (make stress N=...): every STRESS_FRAMES frames one
+ *  more bouncing circle or rect is spawned from a pool of STRESS_N,
+ *  and the top row shows, averaged over those frames,
+ *    n  shapes spawned
+ *    f  frame time (commit + flush) in ms
+ *    p  shape checks per redrawn pixel (shapeLib built with STATS=1)
+ *    t  physics (mlAdvance) time per tick in us
+ *  Timer1_A (timeBase) counts SMCLK/8 (4us) to time both.
+ */
+#define STRESS_FRAMES 16
+
+LAYER_POOL(stressPool, STRESS_N);
+AbRect stressRect = {abRectGetBounds, abRectCheck, {4,4}};
+static const u_int stressColors[] = {
+  COLOR_GREEN, COLOR_YELLOW, COLOR_CYAN, COLOR_PINK, COLOR_WHITE, COLOR_GOLD
+};
+
+static char stressText[22];
+AbText stressLabel = {abTextGetBounds, abTextCheck, stressText};
+Layer stressLayer = {		/**< statistics in the top row */
+  (AbShape *)&stressLabel,
+  {0,0},
+  {0,0}, {0,0},				    /* last & next pos */
+  COLOR_WHITE,
+  0
+};
+
+static u_char stressCount;
+static unsigned long stressFrameTicks, stressPixels;
+static volatile unsigned long stressPhysTicks; /* summed by the tick handler */
+static volatile u_int stressTicks;	/* physics ticks since last report */
+
+static void
+stressSpawn()
+{
+  MovLayer *ml = layerPoolAlloc(&stressPool);
+  if (!ml)
+    return;			/* pool full: keep measuring this n */
+  ml->layer->abShape = (stressCount & 1) ? (AbShape *)&stressRect : (AbShape *)&circle5;
+  ml->layer->pos = screenCenter;
+  ml->layer->pos.axes[0] += (stressCount & 7) * 3 - 12;
+  ml->layer->color = stressColors[stressCount % 6];
+  ml->velocity.axes[0] = 1 + stressCount % 3;
+  ml->velocity.axes[1] = 1 + (stressCount + 1) % 3;
+  layerPoolSpawn(ml, &layer0, &ml0);
+  stressCount++;
+}
+
+static void
+stressFrame(u_int ticks, u_int pixels)
+{
+  static u_char frames;
+  char *p = stressText;
+  unsigned long physTicks;
+  u_int physCount;
+  stressFrameTicks += ticks;
+  stressPixels += pixels;
+  if (++frames < STRESS_FRAMES)
+    return;
+  layerMarkDirty(&stressLayer);	/* old text */
+  *p++ = 'n'; p = putDecimal(p, stressCount, 0, 0);
+  *p++ = ' '; *p++ = 'f'; p = putDecimal(p, stressFrameTicks * 4 / 100 / frames, 0, 1);
+#ifdef SHAPE_STATS
+  *p++ = ' '; *p++ = 'p';
+  p = putDecimal(p, stressPixels ? layerProbes * 10 / stressPixels : 0, 0, 1);
+  layerProbes = 0;
+#endif
+  and_sr(~8);			/* the tick handler adds to these */
+  physTicks = stressPhysTicks;
+  physCount = stressTicks;
+  stressPhysTicks = stressTicks = 0;
+  or_sr(8);
+  *p++ = ' '; *p++ = 't';
+  p = putDecimal(p, physCount ? physTicks * 4 / physCount : 0, 0, 0);
+  *p = 0;
+  layerMarkDirty(&stressLayer);	/* new text */
+  frames = 0;
+  stressFrameTicks = stressPixels = 0;
+  stressSpawn();
+}
+#endif // STRESS_N
+
 
 u_int bgColor = COLOR_BLACK;     /**< The background color */
-int redrawScreen = 1;           /**< Boolean for whether screen needs to be redrawn */
+
+/** Shows the square white while it touches the circle.  (The red
+ *  LED's pin, P1.0, is the LCD's chip select.)
+ */
+static void
+showTouch(int touching)
+{
+  u_int color = touching ? COLOR_WHITE : COLOR_RED;
+  if (layer1.color != color) {
+    layer1.color = color;
+    layerMarkDirty(&layer1);	/**< redrawn next frame */
+  }
+}
 
 Region fieldFence;		/**< fence around playing field  */
+unsigned long bootTicks;	/**< time from reset to the first frame */
+
+#define PHYSICS_TICKS TIME_US(61440) /**< 15 of the old watchdog intervals */
+
+/** Advances the shapes, then wakes the renderer */
+int physicsTick(SoftTimer *t)
+{
+  P1OUT |= GREEN_LED;		      /**< Green LED on when cpu on */
+#ifdef STRESS_N
+  u_int start = timeNow16();
+  mlAdvance(&ml0, &fieldFence);
+  stressPhysTicks += timeElapsed16(start);
+  stressTicks++;
+#else
+  mlAdvance(&ml0, &fieldFence);
+#endif
+  movLayerPublish();
+  return 1;
+}
+
+SoftTimer physicsTimer = {0, 0, physicsTick};
 
 
 /** Initializes everything, enables interrupts and green LED, 
@@ -184,49 +255,71 @@ Region fieldFence;		/**< fence around playing field  */
  */
 void main()
 {
+  u_int lcdWait;
+  unsigned long lcdReady;
   P1DIR |= GREEN_LED;		/**< Green led on when CPU on */		
   P1OUT |= GREEN_LED;
 
   configureClocks();
-  lcd_init();
+  timeInit();		      /**< Timer1_A: SMCLK/8, free running */
+  lcdWait = lcd_initStep();   /**< the panel resets while we set up */
+  lcdReady = timeDeadline(TIME_MS(lcdWait));
   shapeInit();
   p2sw_init(1);
 
   shapeInit();
 
+#ifdef STRESS_N
+  layer3.next = &stressLayer;
+#endif
   layerInit(&layer0);
-  layerDraw(&layer0);
+#ifndef STRESS_N
+  collideWatch(touchLayers, 2);
+#endif
 
 
   layerGetBounds(&fieldLayer, &fieldFence);
 
 
-  enableWDTInterrupts();      /**< enable periodic interrupt */
+  softTimerStart(&physicsTimer, PHYSICS_TICKS, PHYSICS_TICKS);
   or_sr(0x8);	              /**< GIE (enable interrupts) */
 
+  while (lcdWait) {	      /**< sleep out the rest of each panel delay */
+    long left = lcdReady - timeNow();
+    if (left > 0)
+      timeDelay(left);
+    lcdWait = lcd_initStep();
+    lcdReady = timeDeadline(TIME_MS(lcdWait));
+  }
+  layerDrawFirst(&layer0);    /**< field covers the screen: one full pass */
+  bootTicks = timeNow();
+#ifdef STRESS_N
+  {
+    char *p = stressText;
+    *p++ = 'b'; p = putDecimal(p, bootTicks / TIME_MS(1), 0, 0);
+    *p++ = 'm'; *p++ = 's'; *p = 0;
+    layerMarkDirty(&stressLayer);
+  }
+#endif
+
 
   for(;;) { 
-    while (!redrawScreen) { /**< Pause CPU if screen doesn't need updating */
-      P1OUT &= ~GREEN_LED;    /**< Green led off witHo CPU */
-      or_sr(0x10);	      /**< CPU OFF */
-    }
+    P1OUT &= ~GREEN_LED;      /**< Green led off witHo CPU */
+    powerSleepUntil(framePending); /**< CPU OFF (LPM1 while the timer runs) until layers move */
     P1OUT |= GREEN_LED;       /**< Green led on when CPU on */
-    redrawScreen = 0;
-    movLayerDraw(&ml0, &layer0);
+    framePending = 0;
+#ifdef STRESS_N
+    {
+      u_int start = timeNow16(), pixels;
+      movLayerCommit(&ml0);
+      pixels = frameFlush(&layer0);
+      stressFrame(timeElapsed16(start), pixels);
+    }
+#else
+    movLayerCommit(&ml0);     /**< marks tiles that changed */
+    collideClear();
+    frameFlush(&layer0);      /**< redraws only those tiles */
+    showTouch(layerCollided(&layer0, &layer1));
+#endif
   }
 }
-
-/** Watchdog timer interrupt handler. 15 interrupts/sec */
-void wdt_c_handler()
-{
-  static short count = 0;
-  P1OUT |= GREEN_LED;		      /**< Green LED on when cpu on */
-  count ++;
-  if (count == 15) {
-    mlAdvance(&ml0, &fieldFence);
-    if (p2sw_read())
-      redrawScreen = 1;
-    count = 0;
-  } 
-  P1OUT &= ~GREEN_LED;		    /**< Green LED off when cpu off */
-}
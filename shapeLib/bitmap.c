@@ -0,0 +1,43 @@
+#include "shape.h"
+
+void
+abBitmapGetBounds(const AbBitmap *bitmap, const Vec2 *centerPos, Region *bounds)
+{
+  const Bitmap *b = bitmap->bitmap;
+  bounds->topLeft.axes[0] = centerPos->axes[0] - b->width / 2;
+  bounds->topLeft.axes[1] = centerPos->axes[1] - b->height / 2;
+  bounds->botRight.axes[0] = bounds->topLeft.axes[0] + b->width - 1;
+  bounds->botRight.axes[1] = bounds->topLeft.axes[1] + b->height - 1;
+}
+
+/** Walks row's runs from its rowStart entry.  Neighbouring runs of
+ *  one color (split at 16 pixels by the encoding) are joined, so a
+ *  solid stretch is a single span.
+ */
+int
+abBitmapSpan(const AbBitmap *bitmap, const Vec2 *centerPos, int row, int col, Span *span)
+{
+  const Bitmap *b = bitmap->bitmap;
+  int left = centerPos->axes[0] - b->width / 2;
+  int r = row - (centerPos->axes[1] - b->height / 2);
+  int x = left, end = left + b->width;
+  const u_char *run;
+
+  if (r < 0 || r >= b->height)
+    return 0;
+  run = b->data + b->rowStart[r];
+  while (x < end) {
+    u_char index = BITMAP_RUN_INDEX(*run);
+    int next = x + BITMAP_RUN_LENGTH(*run++);
+    if (next > col && index != b->transparent) {
+      while (next < end && BITMAP_RUN_INDEX(*run) == index) /* join */
+	next += BITMAP_RUN_LENGTH(*run++);
+      span->col0 = (x > col) ? x : col;
+      span->col1 = next - 1;
+      span->color = b->palette[index];
+      return 1;
+    }
+    x = next;
+  }
+  return 0;
+}
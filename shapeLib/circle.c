@@ -1,5 +1,4 @@
 #include "shape.h"
-#include "_abCircle.h"
 
 // true if pixel is in circle centered at centerPos
 int abCircleCheck(const AbCircle *circle, const Vec2 *centerPos, const Vec2 *pixel)
@@ -20,6 +19,5 @@ abCircleGetBounds(const AbCircle *circle, const Vec2 *centerPos, Region *bounds)
     bounds->topLeft.axes[axis] = centerPos->axes[axis] - radius;
     bounds->botRight.axes[axis] = centerPos->axes[axis] + radius;
   }
-  regionClipScreen(bounds);
 }
 
@@ -0,0 +1,49 @@
+#include "shape.h"
+
+static Layer *const *watched;
+static u_char watchedCount;
+static u_char pairs[COLLIDE_MAX];	/* bit j of pairs[i]: i and j met */
+
+void
+collideWatch(Layer *const *layers, u_char n)
+{
+  watched = layers;
+  watchedCount = n;
+  collideClear();
+}
+
+void
+collideClear()
+{
+  u_char i;
+  for (i = 0; i < COLLIDE_MAX; i++)
+    pairs[i] = 0;
+}
+
+u_char
+collideIndex(const Layer *l)
+{
+  u_char i;
+  for (i = 0; i < watchedCount; i++)
+    if (watched[i] == l)
+      return i;
+  return COLLIDE_MAX;
+}
+
+u_char
+collideRecord(u_char index, u_char found)
+{
+  u_char j, bit = 1 << index, others = found;
+  pairs[index] |= found;
+  for (j = 0; others; j++, others >>= 1)
+    if (others & 1)
+      pairs[j] |= bit;
+  return found | bit;
+}
+
+int
+layerCollided(const Layer *a, const Layer *b)
+{
+  u_char i = collideIndex(a), j = collideIndex(b);
+  return i < COLLIDE_MAX && j < COLLIDE_MAX && (pairs[i] & (1 << j));
+}
@@ -0,0 +1,79 @@
+///////////////////////////////////////////
+// commitTest: host check of movLayerCommit()
+//
+//   make test   (or ./commitTest [commits])
+//
+// A SIGALRM every few microseconds plays the tick handler: it writes
+// one new value into every mover's posNext, then calls
+// movLayerPublish().  The main loop commits over and over and checks
+// that all movers always come out of one publish.
+// Exits 1 if a torn snapshot is seen.
+///////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include <signal.h>
+#include <sys/time.h>
+#include "shape.h"
+
+#define MOVERS 8
+
+u_int bgColor;
+volatile u_char framePending;
+
+/* the commits only need these to exist */
+void layerMarkDirty(const Layer *l) {}
+u_int frameFlush(Layer *layers) { return 0; }
+
+AbRect dot = {abRectGetBounds, abRectCheck, {1,1}};
+
+static Layer layers[MOVERS];
+static MovLayer movers[MOVERS];
+
+static unsigned long publishes;
+
+/* the "tick handler" */
+static void
+tick(int sig)
+{
+  static int value;
+  int i;
+  value++;
+  for (i = 0; i < MOVERS; i++) {
+    layers[i].posNext.axes[0] = value;
+    layers[i].posNext.axes[1] = -value;
+  }
+  movLayerPublish();
+  publishes++;
+}
+
+int
+main(int argc, char **argv)
+{
+  unsigned long commits = (argc > 1) ? strtoul(argv[1], 0, 10) : 1000000, n, torn = 0;
+  struct itimerval every = {{0, 5}, {0, 5}}; /* as often as the host allows */
+  int i;
+
+  for (i = 0; i < MOVERS; i++) {
+    movers[i].layer = &layers[i];
+    movers[i].next = (i + 1 < MOVERS) ? &movers[i + 1] : 0;
+  }
+  signal(SIGALRM, tick);
+  setitimer(ITIMER_REAL, &every, 0);
+
+  for (n = 0; n < commits; n++) {
+    movLayerCommit(movers);
+    for (i = 1; i < MOVERS; i++) {
+      if (layers[i].pos.axes[0] != layers[0].pos.axes[0] ||
+	  layers[i].pos.axes[1] != layers[0].pos.axes[1] ||
+	  layers[0].pos.axes[0] != -layers[0].pos.axes[1]) {
+	torn++;
+	break;
+      }
+    }
+  }
+
+  every.it_interval.tv_usec = every.it_value.tv_usec = 0;
+  setitimer(ITIMER_REAL, &every, 0);
+  printf("commitTest: %lu commits, %lu publishes, %lu torn\n", commits, publishes, torn);
+  return torn != 0;
+}
@@ -0,0 +1,155 @@
+#include "shape.h"
+
+#define isRect(s) ((void *)(s)->check == (void *)abRectCheck)
+
+/* child's first run in row ending at or after col (as AbSpanShape's
+   span), with child centered at centerPos + offset and its walk (or
+   0) in walk */
+static int
+childSpan(const AbShape *child, const Vec2 *centerPos, const Vec2 *offset,
+	  int row, int col, Span *span, SpanWalk *walk)
+{
+  Vec2 pos;
+  Region bounds;
+  int right;
+  vec2Add(&pos, centerPos, offset);
+  if (abShapeHasSpans(child)) {
+    const AbSpanShape *s = (const AbSpanShape *)child;
+    span->walk = walk;
+    return (*s->span)(s, &pos, row, col, span);
+  }
+  abShapeGetBounds(child, &pos, &bounds);
+  right = bounds.botRight.axes[0];
+  if (row < bounds.topLeft.axes[1] || row > bounds.botRight.axes[1] || col > right)
+    return 0;
+  if (col < bounds.topLeft.axes[0])
+    col = bounds.topLeft.axes[0];
+  if (isRect(child)) {		/* the bounds are the rect */
+    span->col0 = col;
+    span->col1 = right;
+    return 1;
+  }
+  for (; col <= right; col++) {	/* find the run's ends by checks */
+    Vec2 pixel = {col, row};
+    if (abShapeCheck(child, &pos, &pixel)) {
+      span->col0 = col;
+      for (pixel.axes[0]++; pixel.axes[0] <= right && abShapeCheck(child, &pos, &pixel);
+	   pixel.axes[0]++)
+	;
+      span->col1 = pixel.axes[0] - 1;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+#define walkA(csg) ((csg)->walks)
+#define walkB(csg) ((csg)->walks ? (csg)->walks + 1 : 0)
+
+/* next run of a or b; a's run wins where they overlap */
+static int
+unionRun(const AbCsg *csg, const Vec2 *centerPos, int row, int col, Span *span)
+{
+  Span sb;
+  int ha, hb;
+  sb.color = span->color;
+  ha = childSpan(csg->a, centerPos, &csg->posA, row, col, span, walkA(csg));
+  hb = childSpan(csg->b, centerPos, &csg->posB, row, col, &sb, walkB(csg));
+  if (!hb || (ha && span->col0 <= sb.col0))
+    return ha;
+  if (ha && sb.col1 >= span->col0)
+    sb.col1 = span->col0 - 1;	/* b only up to where a starts */
+  *span = sb;
+  return 1;
+}
+
+void
+abCsgGetBounds(const AbCsg *csg, const Vec2 *centerPos, Region *bounds)
+{
+  Vec2 pos;
+  Region boundsB;
+  vec2Add(&pos, centerPos, &csg->posA);
+  abShapeGetBounds(csg->a, &pos, bounds);
+  if (csg->op == CSG_DIFFERENCE)
+    return;
+  vec2Add(&pos, centerPos, &csg->posB);
+  abShapeGetBounds(csg->b, &pos, &boundsB);
+  if (csg->op == CSG_UNION) {
+    regionUnion(bounds, bounds, &boundsB);
+  } else {			/* empty if the children are apart */
+    vec2Max(&bounds->topLeft, &bounds->topLeft, &boundsB.topLeft);
+    vec2Min(&bounds->botRight, &bounds->botRight, &boundsB.botRight);
+  }
+}
+
+/** Runs are combined, never pixels: each step costs one child span
+ *  and skips to the end of a run, so a row with k runs is done in
+ *  O(k) child calls.  Union joins pieces of one color that touch.
+ */
+static int
+csgRun(const AbCsg *csg, const Vec2 *centerPos, int row, int col, Span *span)
+{
+  u_int color = span->color;
+  Span sb;
+
+  switch (csg->op) {
+  case CSG_UNION:
+    if (!unionRun(csg, centerPos, row, col, span))
+      return 0;
+    for (;;) {			/* join a's run to b's beyond it, etc. */
+      Span next;
+      next.color = color;
+      if (!unionRun(csg, centerPos, row, span->col1 + 1, &next) ||
+	  next.col0 != span->col1 + 1 || next.color != span->color)
+	return 1;
+      span->col1 = next.col1;
+    }
+  case CSG_INTERSECT:
+    for (;;) {
+      span->color = color;	/* a may have left b's color */
+      if (!childSpan(csg->a, centerPos, &csg->posA, row, col, span, walkA(csg)))
+	return 0;
+      sb.color = color;
+      if (!childSpan(csg->b, centerPos, &csg->posB, row, span->col0, &sb, walkB(csg)))
+	return 0;
+      if (sb.col0 <= span->col1) {
+	if (sb.col0 > span->col0) span->col0 = sb.col0;
+	if (sb.col1 < span->col1) span->col1 = sb.col1;
+	return 1;
+      }
+      col = sb.col0;		/* b's next run starts past a's */
+    }
+  default:			/* CSG_DIFFERENCE */
+    if (!childSpan(csg->a, centerPos, &csg->posA, row, col, span, walkA(csg)))
+      return 0;
+    for (;;) {
+      sb.color = color;
+      if (!childSpan(csg->b, centerPos, &csg->posB, row, span->col0, &sb, walkB(csg)) ||
+	  sb.col0 > span->col1)
+	return 1;		/* b misses a's run */
+      if (sb.col0 > span->col0) {
+	span->col1 = sb.col0 - 1; /* a up to b */
+	return 1;
+      }
+      if (sb.col1 < span->col1) {	/* b covers the start: a after b */
+	span->col0 = sb.col1 + 1;
+	continue;
+      }
+      span->color = color;
+      if (!childSpan(csg->a, centerPos, &csg->posA, row, sb.col1 + 1, span, walkA(csg)))
+	return 0;
+    }
+  }
+}
+
+/** The children's runs use csg->walks, so the caller's walk is kept
+ *  aside and given back
+ */
+int
+abCsgSpan(const AbCsg *csg, const Vec2 *centerPos, int row, int col, Span *span)
+{
+  SpanWalk *walk = span->walk;
+  int found = csgRun(csg, centerPos, row, col, span);
+  span->walk = walk;
+  return found;
+}
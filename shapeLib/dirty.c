@@ -0,0 +1,123 @@
+#include "lcdutils.h"
+#include "shape.h"
+
+#define TILE_ROW_BYTES ((TILE_COLS + 7) >> 3)
+
+static u_char dirtyTiles[TILE_ROWS][TILE_ROW_BYTES]; /* bit per tile */
+
+volatile u_char framePending = 1; /* draw once at startup */
+
+static int
+clampAxis(int val, int limit)
+{
+  if (val < 0)
+    return 0;
+  return val < limit ? val : limit - 1;
+}
+
+void
+dirtyRegion(const Region *region)
+{
+  int col0 = clampAxis(region->topLeft.axes[0], screenWidth) >> TILE_SHIFT;
+  int col1 = clampAxis(region->botRight.axes[0], screenWidth) >> TILE_SHIFT;
+  int row0 = clampAxis(region->topLeft.axes[1], screenHeight) >> TILE_SHIFT;
+  int row1 = clampAxis(region->botRight.axes[1], screenHeight) >> TILE_SHIFT;
+  int row, col;
+  if (region->botRight.axes[0] < 0 || region->botRight.axes[1] < 0 ||
+      region->topLeft.axes[0] >= screenWidth ||
+      region->topLeft.axes[1] >= screenHeight)
+    return;			/* entirely off screen */
+  for (row = row0; row <= row1; row++)
+    for (col = col0; col <= col1; col++)
+      dirtyTiles[row][col >> 3] |= 1 << (col & 7);
+}
+
+void
+dirtyAll()
+{
+  Region screen = {{0,0}, {screenWidth-1, screenHeight-1}};
+  dirtyRegion(&screen);
+}
+
+void
+dirtyClear()
+{
+  u_char row, i;
+  for (row = 0; row < TILE_ROWS; row++)
+    for (i = 0; i < TILE_ROW_BYTES; i++)
+      dirtyTiles[row][i] = 0;
+}
+
+void
+layerMarkDirty(const Layer *l)
+{
+  Region bounds;
+  layerGetBounds(l, &bounds);
+  dirtyRegion(&bounds);
+}
+
+static int
+tileDirty(u_char row, u_char col)
+{
+  return dirtyTiles[row][col >> 3] & (1 << (col & 7));
+}
+
+static void
+tileClear(u_char row, u_char col)
+{
+  dirtyTiles[row][col >> 3] &= ~(1 << (col & 7));
+}
+
+static void
+drawLayers(void *layers, const Region *area)
+{
+  layerDrawRegion((Layer *)layers, area);
+}
+
+u_int
+frameFlush(Layer *layers)
+{
+  return dirtyFlush(drawLayers, layers);
+}
+
+/** Tiles are flushed top to bottom, left to right.  Each run of dirty
+ *  tiles in a row is grown downward while the rows below are dirty
+ *  across the same columns, so a moving shape usually costs a single
+ *  lcd window.
+ */
+u_int
+dirtyFlush(void (*draw)(void *scene, const Region *area), void *scene)
+{
+  u_char row, col, col0, row1, c;
+  u_int pixels = 0;
+  for (row = 0; row < TILE_ROWS; row++) {
+    for (col = 0; col < TILE_COLS; col++) {
+      if (!tileDirty(row, col))
+	continue;
+      for (col0 = col; col + 1 < TILE_COLS && tileDirty(row, col + 1); col++)
+	;
+      for (row1 = row + 1; row1 < TILE_ROWS; row1++) { /* grow downward */
+	for (c = col0; c <= col && tileDirty(row1, c); c++)
+	  ;
+	if (c <= col)
+	  break;
+      }
+      row1--;
+      {
+	u_char r;
+	Region area;
+	for (r = row; r <= row1; r++)
+	  for (c = col0; c <= col; c++)
+	    tileClear(r, c);
+	area.topLeft.axes[0] = col0 << TILE_SHIFT;
+	area.topLeft.axes[1] = row << TILE_SHIFT;
+	area.botRight.axes[0] = clampAxis(((col + 1) << TILE_SHIFT) - 1, screenWidth);
+	area.botRight.axes[1] = clampAxis(((row1 + 1) << TILE_SHIFT) - 1, screenHeight);
+	(*draw)(scene, &area);
+	pixels += (area.botRight.axes[0] - area.topLeft.axes[0] + 1) *
+	  (area.botRight.axes[1] - area.topLeft.axes[1] + 1);
+      }
+    }
+  }
+  return pixels;
+}
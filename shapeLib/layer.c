@@ -1,29 +1,176 @@
 #include "lcdutils.h"
 #include "lcddraw.h"
+#include "lcdblit.h"
 #include "shape.h"
 
+#ifdef SHAPE_STATS
+unsigned long layerProbes;
+# define COUNT_PROBE() (layerProbes++)
+#else
+# define COUNT_PROBE()
+#endif
+
 void
 layerDraw(Layer *layers)
+{
+  Region screen = {{0,0}, {screenWidth-1, screenHeight-1}};
+  layerDrawRegion(layers, &screen);
+}
+
+/** A fill runs at SPI speed, but when the layers' bounds cover much
+ *  of the screen (a field outline, say), compositing them afterwards
+ *  repeats most of the fill, and one layerDraw() pass is cheaper.
+ */
+void
+layerDrawFirst(Layer *layers)
+{
+  Layer *l;
+  Region bounds;
+  unsigned long area = 0;	/* layer bounds, overlaps counted twice */
+  for (l = layers; l; l = l->next) {
+    layerGetBounds(l, &bounds);
+    area += (unsigned long)(bounds.botRight.axes[0] - bounds.topLeft.axes[0] + 1) *
+      (bounds.botRight.axes[1] - bounds.topLeft.axes[1] + 1);
+  }
+  dirtyClear();			/* either way everything is drawn */
+  if (area >= (unsigned long)screenWidth * screenHeight / 2) {
+    layerDraw(layers);
+    return;
+  }
+  clearScreen(bgColor);
+  if (bgTilemap)
+    tilemapDraw(bgTilemap);
+  for (l = layers; l; l = l->next)
+    layerMarkDirty(l);
+  frameFlush(layers);
+}
+
+#define SPAN_LAYERS 4		/* top layers whose runs are cached per row */
+#define SPAN_WALKS 2		/* of those, the first with a SpanWalk */
+#define SPAN_NONE 0x7fff	/* no run left in this row */
+
+/* l's next run in row at or after col, or col0 = col1 = SPAN_NONE */
+static void
+spanFetch(const Layer *l, int row, int col, Span *span)
+{
+  const AbSpanShape *s = (const AbSpanShape *)l->abShape;
+  span->color = l->color;
+  if (!(*s->span)(s, &l->pos, row, col, span))
+    span->col0 = span->col1 = SPAN_NONE;
+}
+
+/* does l cover pixel?  span: l's cached run, or 0 to call its check */
+static int
+layerHit(const Layer *l, Span *span, const Vec2 *pixel)
+{
+  int col = pixel->axes[0];
+  if (span) {			/* two compares instead of a check */
+    if (col > span->col1)
+      spanFetch(l, pixel->axes[1], col, span);
+    return col >= span->col0;
+  }
+  COUNT_PROBE();
+  return abShapeCheck(l->abShape, &l->pos, pixel);
+}
+
+/* top (layer i) covers pixel: record it with every watched layer
+   from it down (bit j of watch: layer i + j is watched, and its
+   collision index is watchIndex[i + j]) that does too */
+static void
+collideScan(const Layer *top, u_char i, u_char watch, const u_char *watchIndex,
+	    Span *spans, u_char spanLayers, const Vec2 *pixel)
+{
+  u_char found = 0;
+  const Layer *l;
+  if (watch & 1)
+    found = collideRecord(watchIndex[i], 0);
+  for (l = top->next, i++, watch >>= 1; l && watch; l = l->next, i++, watch >>= 1) {
+    Span *span = (i < SPAN_LAYERS && (spanLayers >> i) & 1) ? &spans[i] : 0;
+    if ((watch & 1) && layerHit(l, span, pixel))
+      found = collideRecord(watchIndex[i], found);
+  }
+}
+
+/* area's pixels; spans: the current run of each layer i with bit i
+   of spanLayers set */
+static void
+drawRows(Layer *layers, const Region *area, Span *spans, u_char spanLayers)
 {
   int row, col;
-  for (row = 0; row < screenHeight; row++) {
-    lcd_setArea(0, row, screenWidth-1, row);
-    for (col = 0; col < screenWidth; col++) {
+  u_int runColor = bgColor, runLength = 0; /* pixels not yet sent */
+  u_char bit, i;
+  u_char watch = 0, wbit;	 /* bit i set: layer i is watched */
+  u_char watchIndex[8];		 /* collision index of watched layer i */
+  Layer *probeLayer;
+
+  for (probeLayer = layers, wbit = 1, i = 0; probeLayer && wbit;
+       probeLayer = probeLayer->next, wbit <<= 1, i++)
+    if ((watchIndex[i] = collideIndex(probeLayer)) < COLLIDE_MAX)
+      watch |= wbit;
+  lcd_setArea(area->topLeft.axes[0], area->topLeft.axes[1],
+	      area->botRight.axes[0], area->botRight.axes[1]);
+  for (row = area->topLeft.axes[1]; row <= area->botRight.axes[1]; row++) {
+    BgRow bg;
+    bgRowStart(&bg, row);
+    for (probeLayer = layers, i = 0; probeLayer && i < SPAN_LAYERS; probeLayer = probeLayer->next, i++)
+      if (spanLayers & (1 << i))
+	spanFetch(probeLayer, row, area->topLeft.axes[0], &spans[i]);
+    for (col = area->topLeft.axes[0]; col <= area->botRight.axes[0]; col++) {
       Vec2 pixelPos = {col, row};
       u_int color = bgColor;
-      Layer *probeLayer;
-      for (probeLayer = layers; probeLayer; probeLayer = probeLayer->next) {
-	if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
-	  color = probeLayer->color;
-	  break; 
-	} /* if check */
-      } // for checking all layers at col, row
-      lcd_writeColor(color); 
+      for (probeLayer = layers, i = 0, bit = 1; probeLayer;
+	   probeLayer = probeLayer->next, i++, bit <<= 1)
+	if (layerHit(probeLayer, (spanLayers & bit) ? &spans[i] : 0, &pixelPos))
+	  break;
+      if (probeLayer) {
+	color = (spanLayers & bit) ? spans[i].color : probeLayer->color;
+	wbit = (i < 8) ? watch >> i : 0; /* watched: the hit and below */
+	if (wbit)
+	  collideScan(probeLayer, i, wbit, watchIndex, spans, spanLayers, &pixelPos);
+      } else if (bg.cells) {	/* no layer: from the tilemap */
+	color = bgRowPixel(&bg, col);
+      }
+      if (color != runColor && runLength) { /* runs continue across rows */
+	lcd_fillRun(runColor, runLength);
+	runLength = 0;
+      }
+      runColor = color;
+      runLength++;
     } // for col
   } // for row
-} 
+  lcd_fillRun(runColor, runLength);
+}
 
+/* Kept out of layerDrawRegion, so that the span cache (52 bytes) is
+   on the stack only while a layer has spans */
+static void __attribute__((noinline))
+drawSpanned(Layer *layers, const Region *area, u_char spanLayers)
+{
+  Span spans[SPAN_LAYERS];
+  SpanWalk walks[SPAN_WALKS];
+  u_char i, w = 0;
+  for (i = 0; i < SPAN_LAYERS; i++)
+    if (spanLayers & (1 << i)) {
+      spans[i].walk = (w < SPAN_WALKS) ? &walks[w] : 0;
+      if (w < SPAN_WALKS)
+	spanWalkReset(&walks[w++]);
+    }
+  drawRows(layers, area, spans, spanLayers);
+}
 
+void
+layerDrawRegion(Layer *layers, const Region *area)
+{
+  u_char spanLayers = 0, bit, i; /* bit i set: layer i has spans */
+  Layer *l;
+  for (l = layers, bit = 1, i = 0; l && i < SPAN_LAYERS; l = l->next, bit <<= 1, i++)
+    if (abShapeHasSpans(l->abShape))
+      spanLayers |= bit;
+  if (spanLayers)
+    drawSpanned(layers, area, spanLayers);
+  else
+    drawRows(layers, area, 0, 0);
+}
 
 void
 layerGetBounds(const Layer *l, Region *bounds)
@@ -41,4 +188,3 @@ layerInit(Layer *layer)
   for (; layer; layer = layer->next)
     layer->posLast = layer->posNext = layer->pos;
 }
-
@@ -55,17 +55,6 @@ void drawArena()
   drawRectOutline(LEFT_BOUNDARY, LOWER_BOUNDARY, ARENA_WIDTH, ARENA_HEIGHT, COLOR_BLACK);
 }
 
-fillCircle(u_char col, u_char row, u_char radius, u_char chords[], u_int color)
-{
-  u_char drow;
-  for (drow = 0; drow < radius; drow++) {
-    u_char dcol = chords[drow];
-    u_char width = 1 + (dcol << 1);
-    fillRectangle(col-dcol, row+drow, width, 1, color);
-    fillRectangle(col-dcol, row-drow, width, 1, color);
-  }
-}
-
 main()
 {
   configureClocks();
@@ -0,0 +1,49 @@
+#include "lcdutils.h"
+#include "shape.h"
+
+volatile u_int movLayerSeq;
+
+/** The tick handler is the only writer of posNext and always runs to
+ *  completion before the main loop resumes, so a publish can only
+ *  land between two of the reader's loads.  Checking movLayerSeq
+ *  after the copy detects that and the copy is simply repeated.
+ */
+void
+movLayerPublish()
+{
+  compilerBarrier();		/* every posNext is written first */
+  movLayerSeq++;
+  framePending = 1;
+}
+
+void
+movLayerCommit(MovLayer *movLayers)
+{
+  MovLayer *movLayer;
+  u_int seq;
+
+  for (movLayer = movLayers; movLayer; movLayer = movLayer->next)
+    movLayer->layer->posLast = movLayer->layer->pos;
+  do {
+    seq = movLayerSeq;
+    compilerBarrier();		/* copy after reading seq ... */
+    for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
+      Layer *l = movLayer->layer;
+      l->pos = l->posNext;
+    }
+    compilerBarrier();		/* ... and before checking it */
+  } while (seq != movLayerSeq);	/* a tick published mid-copy */
+
+  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) {
+    Layer *l = movLayer->layer;
+    if (l->pos.axes[0] != l->posLast.axes[0] || l->pos.axes[1] != l->posLast.axes[1])
+      layerMarkDirty(l);	/* old and new position */
+  }
+}
+
+void
+movLayerDraw(MovLayer *movLayers, Layer *layers)
+{
+  movLayerCommit(movLayers);
+  frameFlush(layers);
+}
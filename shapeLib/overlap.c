@@ -0,0 +1,122 @@
+#include "shape.h"
+
+#define isRect(s) ((void *)(s)->check == (void *)abRectCheck)
+#define isCircle(s) ((void *)(s)->check == (void *)abCircleCheck)
+
+/* Half width of circle's row at distance d from its center (as
+   abCircleCheck reads the chords), or -1 beyond the circle */
+static int
+circleHalfWidth(const AbCircle *circle, int d)
+{
+  int x = circle->radius;
+  if (d < 0)
+    d = -d;
+  if (d > x)
+    return -1;
+  while (circle->chords[x] < d)	/* chords[0] is the radius */
+    x--;
+  return x;
+}
+
+/* The rect's pixel nearest the circle's center is in the circle iff
+   any is: clamping minimizes both distances, and a circle contains
+   every pixel nearer its center on both axes than one it contains */
+static int
+rectCircleOverlap(const AbRect *rect, const Vec2 *rectPos,
+		  const AbCircle *circle, const Vec2 *circlePos)
+{
+  int d[2], axis;
+  for (axis = 0; axis < 2; axis++) {
+    int c = circlePos->axes[axis];
+    int lo = rectPos->axes[axis] - rect->halfSize.axes[axis];
+    int hi = rectPos->axes[axis] + rect->halfSize.axes[axis];
+    int nearest = (c < lo) ? lo : (c > hi) ? hi : c;
+    d[axis] = (nearest > c) ? nearest - c : c - nearest;
+  }
+  return d[0] <= circle->radius && circle->chords[d[0]] >= d[1];
+}
+
+static int
+circleCircleOverlap(const AbCircle *a, const Vec2 *posA,
+		    const AbCircle *b, const Vec2 *posB, const Region *both)
+{
+  int row;
+  for (row = both->topLeft.axes[1]; row <= both->botRight.axes[1]; row++) {
+    int ha = circleHalfWidth(a, row - posA->axes[1]);
+    int hb = circleHalfWidth(b, row - posB->axes[1]);
+    if (posA->axes[0] - ha <= posB->axes[0] + hb &&
+	posB->axes[0] - hb <= posA->axes[0] + ha)
+      return 1;
+  }
+  return 0;
+}
+
+/* Scan both's rows for a shared pixel; a is an AbSpanShape if either is */
+static int
+scanOverlap(const AbShape *a, const Vec2 *posA, const AbShape *b, const Vec2 *posB,
+	    const Region *both)
+{
+  int row, col, colMax = both->botRight.axes[0];
+  Span sa, sb;
+  SpanWalk wa, wb;
+  sa.walk = &wa;
+  sb.walk = &wb;
+  spanWalkReset(&wa);
+  spanWalkReset(&wb);
+  for (row = both->topLeft.axes[1]; row <= both->botRight.axes[1]; row++) {
+    col = both->topLeft.axes[0];
+    if (abShapeHasSpans(b)) {	/* run against run */
+      const AbSpanShape *spanA = (const AbSpanShape *)a, *spanB = (const AbSpanShape *)b;
+      while ((*spanA->span)(spanA, posA, row, col, &sa) && sa.col0 <= colMax &&
+	     (*spanB->span)(spanB, posB, row, sa.col0, &sb) && sb.col0 <= colMax) {
+	if (sb.col0 <= sa.col1)
+	  return 1;
+	col = sb.col0;		/* b's next run starts past a's */
+      }
+    } else if (abShapeHasSpans(a)) { /* a's runs against b's check */
+      const AbSpanShape *spanA = (const AbSpanShape *)a;
+      while ((*spanA->span)(spanA, posA, row, col, &sa) && sa.col0 <= colMax) {
+	int end = (sa.col1 < colMax) ? sa.col1 : colMax;
+	for (col = sa.col0; col <= end; col++) {
+	  Vec2 pixel = {col, row};
+	  if (abShapeCheck(b, posB, &pixel))
+	    return 1;
+	}
+	if (end == colMax)
+	  break;
+      }
+    } else {			/* pixel by pixel */
+      for (; col <= colMax; col++) {
+	Vec2 pixel = {col, row};
+	if (abShapeCheck(a, posA, &pixel) && abShapeCheck(b, posB, &pixel))
+	  return 1;
+      }
+    }
+  }
+  return 0;
+}
+
+int
+abShapeOverlap(const AbShape *a, const Vec2 *posA, const AbShape *b, const Vec2 *posB)
+{
+  Region boundsA, boundsB, both;
+  abShapeGetBounds(a, posA, &boundsA);
+  abShapeGetBounds(b, posB, &boundsB);
+  vec2Max(&both.topLeft, &boundsA.topLeft, &boundsB.topLeft);
+  vec2Min(&both.botRight, &boundsA.botRight, &boundsB.botRight);
+  if (both.topLeft.axes[0] > both.botRight.axes[0] ||
+      both.topLeft.axes[1] > both.botRight.axes[1])
+    return 0;
+
+  if (isRect(a) && isRect(b))
+    return 1;			/* the bounds are the rects */
+  if (isRect(a) && isCircle(b))
+    return rectCircleOverlap((const AbRect *)a, posA, (const AbCircle *)b, posB);
+  if (isCircle(a) && isRect(b))
+    return rectCircleOverlap((const AbRect *)b, posB, (const AbCircle *)a, posA);
+  if (isCircle(a) && isCircle(b))
+    return circleCircleOverlap((const AbCircle *)a, posA, (const AbCircle *)b, posB, &both);
+  if (abShapeHasSpans(b) && !abShapeHasSpans(a))
+    return scanOverlap(b, posB, a, posA, &both);
+  return scanOverlap(a, posA, b, posB, &both);
+}
@@ -0,0 +1,216 @@
+#include "shape.h"
+
+/* floor(num / den) for den > 0 (C division truncates toward zero) */
+static int
+floorDiv(int num, int den)
+{
+  return (num >= 0) ? num / den : -((den - 1 - num) / den);
+}
+
+#define LEFT 0
+#define RIGHT 1
+
+/* corner after i going step (+-1) around the n corners */
+static u_char
+corner(u_char i, signed char step, u_char n)
+{
+  if (step > 0)
+    return (i + 1 == n) ? 0 : i + 1;
+  return i ? i - 1 : n - 1;
+}
+
+/* side s's edge from corner a down to the next corner, at row y
+   (relative to the center): x = floor of the edge's column there */
+static void
+edgeStart(const Vec2 *v, u_char n, SpanWalk *w, u_char s, u_char a, int y)
+{
+  const Vec2 *p = &v[a], *q = &v[corner(a, s == RIGHT ? w->step : -w->step, n)];
+  int dy = q->axes[1] - p->axes[1], k = (q->axes[0] - p->axes[0]) * (y - p->axes[1]);
+  int x = k ? floorDiv(k, dy) : 0; /* at a corner (k = 0) no divide */
+  w->v[s] = a;
+  w->x[s] = p->axes[0] + x;
+  w->r[s] = k - x * dy;
+}
+
+/* next edge down side s, if y is at its bottom and the side goes on */
+static void
+edgeNext(const Vec2 *v, u_char n, SpanWalk *w, u_char s, int y)
+{
+  signed char step = (s == RIGHT) ? w->step : -w->step;
+  u_char b = corner(w->v[s], step, n);
+  while (v[b].axes[1] == y && v[corner(b, step, n)].axes[1] > y) {
+    w->v[s] = b;		/* the new edge starts exactly at b */
+    w->x[s] = v[b].axes[0];
+    w->r[s] = 0;
+    b = corner(b, step, n);
+  }
+}
+
+#define NONE 0xff		/* v[LEFT]: no run until row x[LEFT] */
+
+/* no run in this row, nor any before row first */
+static void
+walkIdle(SpanWalk *w, int first)
+{
+  w->v[LEFT] = NONE;
+  w->x[LEFT] = first;
+}
+
+/* Find both sides' edges at row y from scratch */
+static void
+walkStart(const Vec2 *v, u_char n, SpanWalk *w, int y)
+{
+  int turn, topY;
+  u_char i, top = 0, s;
+  signed char step;
+  const Vec2 *p, *t, *q;
+  for (i = 1; i < n; i++)
+    if (v[i].axes[1] < v[top].axes[1])
+      top = i;
+  topY = v[top].axes[1];
+  for (i = 0; i < n; i++)	/* the top corner its predecessor rises to */
+    if (v[i].axes[1] == topY && v[corner(i, -1, n)].axes[1] > topY) {
+      top = i;
+      break;
+    }
+  /* With y down, the turn z = (t - p) x (q - t) at that corner tells
+     the winding, and so which way round the corners the right side
+     goes.  p is below t, so the turn is 0 only if all corners are in
+     a line, even where other corners are collinear */
+  p = &v[corner(top, -1, n)];
+  t = &v[top];
+  q = &v[corner(top, 1, n)];
+  turn = (t->axes[0] - p->axes[0]) * (q->axes[1] - t->axes[1])
+    - (t->axes[1] - p->axes[1]) * (q->axes[0] - t->axes[0]);
+  w->step = (turn < 0) ? -1 : 1;	/* nonzero: w holds a state */
+  if (y < topY) {
+    walkIdle(w, topY);
+    return;
+  }
+  for (s = LEFT; s <= RIGHT; s++) {
+    u_char a = top, b;
+    step = (s == RIGHT) ? w->step : -w->step;
+    while (v[b = corner(a, step, n)].axes[1] == topY) /* along a flat top */
+      a = b;
+    while (v[b].axes[1] < y) {	/* down to the edge holding y */
+      if (v[corner(b, step, n)].axes[1] <= v[b].axes[1]) {
+	walkIdle(w, 127);	/* below the bottom */
+	return;
+      }
+      a = b;
+      b = corner(a, step, n);
+    }
+    edgeStart(v, n, w, s, a, y);
+    edgeNext(v, n, w, s, y);
+  }
+}
+
+/* Move both sides' edges down one row to y: additions only */
+static void
+walkStep(const Vec2 *v, u_char n, SpanWalk *w, int y)
+{
+  u_char s;
+  for (s = LEFT; s <= RIGHT; s++) {
+    const Vec2 *p = &v[w->v[s]];
+    const Vec2 *q = &v[corner(w->v[s], s == RIGHT ? w->step : -w->step, n)];
+    int dy = q->axes[1] - p->axes[1], x = w->x[s], r = w->r[s] + q->axes[0] - p->axes[0];
+    if (y > q->axes[1]) {
+      walkIdle(w, 127);		/* past the bottom */
+      return;
+    }
+    while (r >= dy) {
+      r -= dy;
+      x++;
+    }
+    while (r < 0) {
+      r += dy;
+      x--;
+    }
+    w->x[s] = x;
+    w->r[s] = r;
+    edgeNext(v, n, w, s, y);
+  }
+}
+
+/** Shared by triangles and convex polygons.
+ *
+ *  A row's run lies between the left side's edge (rounded up) and the
+ *  right side's (rounded down).  span->walk keeps both edges as a
+ *  column and a remainder, so the next row is a Bresenham step: the
+ *  remainder grows by the edge's dx and columns are carried out of it
+ *  by dy.  Crossing a corner restarts the edge exactly at that corner.
+ *  Only the first row (a row out of order, or every row if span->walk
+ *  is 0) finds the corners and the winding from scratch, with one
+ *  divide per side; rows above and below the polygon cost a compare.
+ */
+static int
+polySpan(const Vec2 *v, u_char n, const Vec2 *centerPos, int row, int col, Span *span)
+{
+  SpanWalk scratch, *w = span->walk;
+  int x0 = centerPos->axes[0];
+  int y = row - centerPos->axes[1];
+  int lo, hi;
+
+  if (!w) {			/* nothing kept: from scratch */
+    w = &scratch;
+    spanWalkReset(w);
+  }
+  if (!w->step || w->y != y) {
+    if (!w->step || w->y != y - 1 || (w->v[LEFT] == NONE && y >= w->x[LEFT]))
+      walkStart(v, n, w, y);
+    else if (w->v[LEFT] != NONE)
+      walkStep(v, n, w, y);
+    w->y = y;
+  }
+  if (w->v[LEFT] == NONE)
+    return 0;
+  lo = w->x[LEFT] + (w->r[LEFT] != 0);
+  hi = w->x[RIGHT];
+  if (lo < col - x0)
+    lo = col - x0;
+  if (lo > hi)
+    return 0;
+  span->col0 = x0 + lo;
+  span->col1 = x0 + hi;
+  return 1;
+}
+
+static void
+polyGetBounds(const Vec2 *v, u_char n, const Vec2 *centerPos, Region *bounds)
+{
+  u_char axis, i;
+  for (axis = 0; axis < 2; axis++) {
+    int min = v[0].axes[axis], max = min;
+    for (i = 1; i < n; i++) {
+      int c = v[i].axes[axis];
+      if (c < min) min = c;
+      if (c > max) max = c;
+    }
+    bounds->topLeft.axes[axis] = centerPos->axes[axis] + min;
+    bounds->botRight.axes[axis] = centerPos->axes[axis] + max;
+  }
+}
+
+void
+abTriangleGetBounds(const AbTriangle *tri, const Vec2 *centerPos, Region *bounds)
+{
+  polyGetBounds(tri->v, 3, centerPos, bounds);
+}
+
+int
+abTriangleSpan(const AbTriangle *tri, const Vec2 *centerPos, int row, int col, Span *span)
+{
+  return polySpan(tri->v, 3, centerPos, row, col, span);
+}
+
+void
+abConvexPolyGetBounds(const AbConvexPoly *poly, const Vec2 *centerPos, Region *bounds)
+{
+  polyGetBounds(poly->v, poly->n, centerPos, bounds);
+}
+
+int
+abConvexPolySpan(const AbConvexPoly *poly, const Vec2 *centerPos, int row, int col, Span *span)
+{
+  return polySpan(poly->v, poly->n, centerPos, row, col, span);
+}
@@ -0,0 +1,68 @@
+#include "lcdutils.h"
+#include "shape.h"
+#include "sr.h"
+
+MovLayer *
+layerPoolAlloc(LayerPool *pool)
+{
+  MovLayer *ml;
+  u_char i;
+  if (pool->freeList) {
+    ml = pool->freeList;
+    pool->freeList = ml->next;
+  } else if (pool->fresh < pool->capacity) {
+    ml = &pool->objs[pool->fresh++].mov;
+  } else
+    return 0;			/* exhausted */
+  if (++pool->used > pool->highWater)
+    pool->highWater = pool->used;
+  {
+    PoolObj *obj = (PoolObj *)ml;
+    u_char *p = (u_char *)obj;
+    for (i = 0; i < sizeof(PoolObj); i++)
+      p[i] = 0;
+    ml->layer = &obj->layer;
+  }
+  return ml;
+}
+
+void
+layerPoolSpawn(MovLayer *ml, Layer *layerAfter, MovLayer *movAfter)
+{
+  Layer *l = ml->layer;
+  u_int sr;
+  l->posLast = l->posNext = l->pos;
+  l->next = layerAfter->next;	/* complete before publishing */
+  ml->next = movAfter->next;
+  sr = get_sr();
+  and_sr(~8);			/**< disable interrupts (GIE off) */
+  layerAfter->next = l;
+  movAfter->next = ml;
+  if (sr & 8)
+    or_sr(8);			/**< back on, if they were */
+  layerMarkDirty(l);
+}
+
+int
+layerPoolDespawn(LayerPool *pool, MovLayer *ml, Layer *layers, MovLayer *movLayers)
+{
+  Layer *l = ml->layer;
+  u_int sr;
+  for (; layers && layers->next != l; layers = layers->next)
+    ;
+  for (; movLayers && movLayers->next != ml; movLayers = movLayers->next)
+    ;
+  if (!layers || !movLayers)
+    return -1;			/* not spawned in these lists */
+  sr = get_sr();
+  and_sr(~8);			/**< disable interrupts (GIE off) */
+  layers->next = l->next;
+  movLayers->next = ml->next;
+  if (sr & 8)
+    or_sr(8);			/**< back on, if they were */
+  layerMarkDirty(l);		/* erase where it was drawn */
+  ml->next = pool->freeList;
+  pool->freeList = ml;
+  pool->used--;
+  return 0;
+}
@@ -0,0 +1,118 @@
+///////////////////////////////////////////
+// poolTest: host check of layerPoolAlloc(), layerPoolSpawn() and
+// layerPoolDespawn()
+//
+//   make test   (or ./poolTest)
+//
+// Fills a pool, spawns every object behind fixed anchors, despawns
+// them in a scrambled order and checks the lists, the counters and the
+// free list after each step.  Despawning an object that is not linked
+// must fail and change nothing.  GIE is played by a variable, and must
+// come back as the caller had it.  Exits 1 on the first failure.
+///////////////////////////////////////////
+#include <stdio.h>
+#include <stdlib.h>
+#include "shape.h"
+#include "sr.h"
+
+#define OBJS 6
+
+u_int bgColor;
+
+/* the status register, as far as the pool uses it */
+static int sr;
+int get_sr(void) { return sr; }
+void set_sr(int v) { sr = v; }
+void or_sr(int v) { sr |= v; }
+void and_sr(int v) { sr &= v; }
+
+static int dirtied;
+void layerMarkDirty(const Layer *l) { dirtied++; }
+
+LAYER_POOL(pool, OBJS);
+
+static Layer anchor;		/* fixed heads, as in shape-motion-demo */
+static MovLayer movAnchor = {&anchor};
+
+static int failures;
+
+static void
+check(int ok, const char *what)
+{
+  if (!ok) {
+    printf("poolTest: %s\n", what);
+    failures++;
+  }
+}
+
+/* objects linked after the anchors; -1 if the two lists disagree */
+static int
+linked()
+{
+  Layer *l = anchor.next;
+  MovLayer *ml = movAnchor.next;
+  int n = 0;
+  for (; ml; ml = ml->next, l = l->next, n++)
+    if (!l || ml->layer != l)
+      return -1;
+  return l ? -1 : n;
+}
+
+static int
+onFreeList(MovLayer *ml)
+{
+  MovLayer *f;
+  for (f = pool.freeList; f; f = f->next)
+    if (f == ml)
+      return 1;
+  return 0;
+}
+
+int
+main()
+{
+  static const u_char order[OBJS] = {3, 0, 5, 1, 4, 2};
+  MovLayer *objs[OBJS], *ml;
+  u_char i;
+
+  for (i = 0; i < OBJS; i++) {
+    objs[i] = layerPoolAlloc(&pool);
+    check(objs[i] != 0, "alloc failed before capacity");
+    objs[i]->layer->pos.axes[0] = i;
+    sr = (i & 1) ? 8 : 0;
+    layerPoolSpawn(objs[i], &anchor, &movAnchor);
+    check(sr == ((i & 1) ? 8 : 0), "spawn changed GIE");
+    check(linked() == i + 1, "spawn: lists wrong");
+  }
+  check(layerPoolAlloc(&pool) == 0, "alloc past capacity");
+  check(pool.used == OBJS && pool.highWater == OBJS, "used/highWater after fill");
+
+  dirtied = 0;
+  for (i = 0; i < OBJS; i++) {
+    ml = objs[order[i]];
+    sr = (i & 1) ? 0 : 8;
+    check(layerPoolDespawn(&pool, ml, &anchor, &movAnchor) == 0, "despawn failed");
+    check(sr == ((i & 1) ? 0 : 8), "despawn changed GIE");
+    check(linked() == OBJS - 1 - i, "despawn: lists wrong");
+    check(onFreeList(ml), "despawned object not free");
+    check(pool.used == OBJS - 1 - i, "used after despawn");
+
+    /* again: no longer linked, so nothing may change */
+    check(layerPoolDespawn(&pool, ml, &anchor, &movAnchor) == -1, "second despawn accepted");
+    check(pool.used == OBJS - 1 - i, "second despawn changed used");
+    check(pool.freeList == ml, "second despawn changed the free list");
+  }
+  check(dirtied == OBJS, "despawn didn't mark each object once");
+  check(pool.highWater == OBJS, "highWater");
+
+  /* in the layer list only: refused, and both lists are left alone */
+  ml = layerPoolAlloc(&pool);
+  check(ml != 0, "alloc from the free list");
+  ml->layer->next = anchor.next;
+  anchor.next = ml->layer;
+  check(layerPoolDespawn(&pool, ml, &anchor, &movAnchor) == -1, "despawn of a half-linked object");
+  check(anchor.next == ml->layer && pool.used == 1, "failed despawn changed something");
+
+  printf("poolTest: %s\n", failures ? "FAILED" : "ok");
+  return failures != 0;
+}
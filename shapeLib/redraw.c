@@ -0,0 +1,30 @@
+#include "lcdutils.h"
+#include "shape.h"
+
+void
+redrawJobStart(RedrawJob *job)
+{
+  job->row = 0;
+  job->active = 1;
+}
+
+int
+redrawJobStep(RedrawJob *job, Layer *layers, u_char rows)
+{
+  Region slice;
+  int lastRow;
+  if (!job->active)
+    return 0;
+  lastRow = job->row + rows - 1;
+  if (lastRow >= screenHeight - 1) {
+    lastRow = screenHeight - 1;
+    job->active = 0;
+  }
+  slice.topLeft.axes[0] = 0;
+  slice.topLeft.axes[1] = job->row;
+  slice.botRight.axes[0] = screenWidth - 1;
+  slice.botRight.axes[1] = lastRow;
+  layerDrawRegion(layers, &slice);
+  job->row = lastRow + 1;
+  return job->active;
+}
@@ -22,3 +22,12 @@ abShapeCheck(const AbShape *s, const Vec2 *centerPos, const Vec2 *pixelLoc)
   return (*s->check)(s, centerPos, pixelLoc);
 }
 
+
+int
+abSpanCheck(const AbSpanShape *s, const Vec2 *centerPos, const Vec2 *pixelLoc)
+{
+  Span span;
+  int col = pixelLoc->axes[0];
+  span.walk = 0;			/* one row: nothing to keep */
+  return (*s->span)(s, centerPos, pixelLoc->axes[1], col, &span) && span.col0 == col;
+}
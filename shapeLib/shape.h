@@ -6,6 +6,7 @@
 #define shape_included
 
 #include "lcdutils.h"
+#include "lcddraw.h"
 
 /** Vec2 contain a position or vector
  *
@@ -150,6 +151,200 @@ void abRectOutlineGetBounds(const AbRect *rect, const Vec2 *centerPos, Region *b
  */
 int abRectOutlineCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel);
 
+/** AbShape circle
+ *  
+ *  chords should be a vector of length radius + 1.  
+ *  Entry at index i is 1/2 chord length at distance i from the circle's center.  
+ *  circleLib generates these (and AbCircles of radius 2..150) with makeCircles.
+ */ 
+typedef struct AbCircle_s {
+  void (*getBounds)(const struct AbCircle_s *circle, const Vec2 *centerPos, Region *bounds);
+  int (*check)(const struct AbCircle_s *circle, const Vec2 *centerPos, const Vec2 *pixel);
+  const u_char *chords;
+  const u_char radius;
+} AbCircle;
+
+/** Required by AbShape.  Like every shape's bounds, not clipped to the
+ *  screen (layerGetBounds() clips what is drawn)
+ */
+void abCircleGetBounds(const AbCircle *circle, const Vec2 *circlePos, Region *bounds);
+
+/** Required by AbShape
+ */
+int abCircleCheck(const AbCircle *circle, const Vec2 *circlePos, const Vec2 *pixel);
+
+/** State a shape may keep from one row to the next, so that the next
+ *  row costs only additions (AbTriangle, AbConvexPoly: the current
+ *  left and right edges).  It is for a row relative to the shape's
+ *  center, so it holds wherever the shape is drawn.  All zero holds
+ *  nothing.
+ */
+typedef struct {
+  int y;			/**< row the state is for, from the center */
+  u_char v[2];			/**< left, right edge: its upper corner (0xff
+				     in v[0]: no run before row x[0]) */
+  signed char x[2], r[2];	/**< edge's column (floor) and remainder */
+  signed char step;		/**< corner order of the right side (+-1),
+				     0: nothing held */
+} SpanWalk;
+
+/** Forget w's state (needed after a shape's corners change) */
+#define spanWalkReset(w) ((w)->step = 0)
+
+/** A run of pixels within one row: columns col0..col1 (inclusive)
+ *
+ *  color is preset to the layer's color; shapes with colors of their
+ *  own (AbBitmap) overwrite it.  walk, if not 0, keeps the shape's
+ *  state between calls: reset it before the first row, then rows in
+ *  order step from where the last one was.  With walk = 0 every call
+ *  starts from scratch.
+ */
+typedef struct {
+  int col0, col1;
+  u_int color;
+  SpanWalk *walk;
+} Span;
+
+/** AbShapes that can also be read a row at a time
+ *
+ *  span: finds the shape's first run in row that ends at or after
+ *  col, with col0 raised to col if the run starts earlier.  Returns
+ *  0 if there is none.  Shapes with several runs per row return the
+ *  next one when called again with col = col1 + 1.
+ *
+ *  check must be abSpanCheck (a check built from span); that is how
+ *  layerDrawRegion() recognizes these shapes and asks for runs
+ *  instead of probing every pixel.  Each span shape declares check
+ *  with this signature, so abSpanCheck initializes it as is.
+ */
+typedef struct AbSpanShape_s {
+  void (*getBounds)(const struct AbSpanShape_s *shape, const Vec2 *centerPos, Region *bounds);
+  int (*check)(const struct AbSpanShape_s *shape, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*span)(const struct AbSpanShape_s *shape, const Vec2 *centerPos, int row, int col, Span *span);
+} AbSpanShape;
+
+/** As required by AbShape, for every AbSpanShape
+ */
+int abSpanCheck(const AbSpanShape *shape, const Vec2 *centerPos, const Vec2 *pixel);
+
+/** True if abShape is an AbSpanShape
+ */
+#define abShapeHasSpans(abShape) ((void *)(abShape)->check == (void *)abSpanCheck)
+
+/** AbShape triangle
+ *
+ *  v: the corners relative to centerPos, in either winding order.
+ *  Corners must stay within 63 pixels of centerPos (the edge setup
+ *  uses 16 bit products, and SpanWalk bytes).
+ */
+typedef struct AbTriangle_s {
+  void (*getBounds)(const struct AbTriangle_s *tri, const Vec2 *centerPos, Region *bounds);
+  int (*check)(const struct AbSpanShape_s *shape, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*span)(const struct AbTriangle_s *tri, const Vec2 *centerPos, int row, int col, Span *span);
+  Vec2 v[3];
+} AbTriangle;
+
+/** As required by AbShape
+ */
+void abTriangleGetBounds(const AbTriangle *tri, const Vec2 *centerPos, Region *bounds);
+
+/** As required by AbSpanShape
+ */
+int abTriangleSpan(const AbTriangle *tri, const Vec2 *centerPos, int row, int col, Span *span);
+
+/** AbShape convex polygon
+ *
+ *  v: n corners relative to centerPos, in either winding order.
+ *  Same 63 pixel limit as AbTriangle.
+ */
+typedef struct AbConvexPoly_s {
+  void (*getBounds)(const struct AbConvexPoly_s *poly, const Vec2 *centerPos, Region *bounds);
+  int (*check)(const struct AbSpanShape_s *shape, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*span)(const struct AbConvexPoly_s *poly, const Vec2 *centerPos, int row, int col, Span *span);
+  u_char n;
+  const Vec2 *v;
+} AbConvexPoly;
+
+/** As required by AbShape
+ */
+void abConvexPolyGetBounds(const AbConvexPoly *poly, const Vec2 *centerPos, Region *bounds);
+
+/** As required by AbSpanShape
+ */
+int abConvexPolySpan(const AbConvexPoly *poly, const Vec2 *centerPos, int row, int col, Span *span);
+
+/** AbShape bitmap sprite (see lcdLib's Bitmap and makeBitmap)
+ *
+ *  centerPos is the bitmap's center.  Pixels in the bitmap's
+ *  transparent palette index are not part of the shape.  The layer's
+ *  color is not used: each run has its palette color.
+ */
+typedef struct AbBitmap_s {
+  void (*getBounds)(const struct AbBitmap_s *bitmap, const Vec2 *centerPos, Region *bounds);
+  int (*check)(const struct AbSpanShape_s *shape, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*span)(const struct AbBitmap_s *bitmap, const Vec2 *centerPos, int row, int col, Span *span);
+  const Bitmap *bitmap;
+} AbBitmap;
+
+/** As required by AbShape
+ */
+void abBitmapGetBounds(const AbBitmap *bitmap, const Vec2 *centerPos, Region *bounds);
+
+/** As required by AbSpanShape
+ */
+int abBitmapSpan(const AbBitmap *bitmap, const Vec2 *centerPos, int row, int col, Span *span);
+
+#define CSG_UNION 0		/* pixels in a or b (a's color where both) */
+#define CSG_INTERSECT 1		/* pixels in both (a's color) */
+#define CSG_DIFFERENCE 2	/* pixels in a but not b */
+
+/** AbShape combining two child shapes (constructive solid geometry)
+ *
+ *  posA, posB: the children's centers relative to centerPos.
+ *  Children may be any AbShape, including another AbCsg.  Rows are
+ *  built from the children's runs: AbSpanShapes give theirs directly,
+ *  AbRects in closed form, and other shapes are checked pixel by
+ *  pixel within their bounds.
+ *
+ *  walks: 0, or two SpanWalks (a's, then b's) that keep a triangle or
+ *  polygon child's edges from row to row; zero them, or
+ *  spanWalkReset() them, after changing a child or its corners.  Every
+ *  span call shares them, so don't test the shape from an interrupt
+ *  while the main loop may be drawing it.
+ */
+typedef struct AbCsg_s {
+  void (*getBounds)(const struct AbCsg_s *csg, const Vec2 *centerPos, Region *bounds);
+  int (*check)(const struct AbSpanShape_s *shape, const Vec2 *centerPos, const Vec2 *pixel);
+  int (*span)(const struct AbCsg_s *csg, const Vec2 *centerPos, int row, int col, Span *span);
+  u_char op;			/* CSG_UNION, CSG_INTERSECT or CSG_DIFFERENCE */
+  const AbShape *a;
+  Vec2 posA;
+  const AbShape *b;
+  Vec2 posB;
+  SpanWalk *walks;
+} AbCsg;
+
+/** As required by AbShape: the union of the children's bounds, their
+ *  intersection, or a's bounds (for CSG_DIFFERENCE)
+ */
+void abCsgGetBounds(const AbCsg *csg, const Vec2 *centerPos, Region *bounds);
+
+/** As required by AbSpanShape
+ */
+int abCsgSpan(const AbCsg *csg, const Vec2 *centerPos, int row, int col, Span *span);
+
+/** True if shapes a at posA and b at posB share a pixel
+ *
+ *  Bounds are compared first.  Rect/rect is then settled by the
+ *  bounds, rect/circle by testing the rect's point nearest the
+ *  circle's center against the chords, and circle/circle by comparing
+ *  the two chords row by row.  Other pairs are scanned over the
+ *  bounds' intersection only: run against run when both are
+ *  AbSpanShapes, one shape's runs against the other's check when one
+ *  is, and pixel by pixel otherwise.
+ */
+int abShapeOverlap(const AbShape *a, const Vec2 *posA, const AbShape *b, const Vec2 *posB);
+
 /** Linked list of Layers.  
  * 
  *  Each layer contains
@@ -179,8 +374,289 @@ void layerInit(Layer *layers);
  */
 void layerDraw(Layer *layers);
 
+/** First frame.  If the layers' bounds cover less than half the
+ *  screen, clears it to bgColor (and draws bgTilemap) with fills, then
+ *  composites only those bounds; otherwise one layerDraw() pass.
+ *  Call after layerInit().
+ */
+void layerDrawFirst(Layer *layers);
+
+/** Render all layers within area (inclusive, already on screen).
+ *  Pixels that are not contained by a layer are set to bgColor.
+ *  The top 8 layers that are AbSpanShapes are read a run at a time.
+ */
+void layerDrawRegion(Layer *layers, const Region *area);
+
+#ifdef SHAPE_STATS
+/** Shape checks made by layerDrawRegion (built with SHAPE_STATS).
+ *  Pixels resolved from a cached span are not counted.
+ */
+extern unsigned long layerProbes;
+#endif
+
+/** Render-time collisions
+ *
+ *  While a set of layers is watched, layerDrawRegion() keeps probing
+ *  watched layers below each pixel's top layer and records every
+ *  pair that covers the same pixel.  Only redrawn pixels are seen, so
+ *  a pair is found in a flush in which one of them moved (or its
+ *  tiles were otherwise dirty).  Pairs accumulate until
+ *  collideClear().
+ */
+#define COLLIDE_MAX 8
+
+/** Watch n (at most COLLIDE_MAX) layers, which must be among the
+ *  first 8 in draw order, and clear the pairs.  n = 0 turns it off.
+ */
+void collideWatch(Layer *const *layers, u_char n);
+
+/** Forget recorded pairs
+ */
+void collideClear();
+
+/** True if a and b (both watched) were seen on the same pixel
+ */
+int layerCollided(const Layer *a, const Layer *b);
+
+/** Position of l in the watched set, or COLLIDE_MAX
+ */
+u_char collideIndex(const Layer *l);
+
+/** Record watched layer index as covering a pixel along with the
+ *  watched layers in found (a bit per index); returns found with
+ *  index added.  Used by layerDrawRegion().
+ */
+u_char collideRecord(u_char index, u_char found);
+
 /** Background color.
   */
 extern u_int bgColor;		/*  background color */
 
+/** Moving Layer
+ *  Linked list of layer references
+ *  Velocity represents one iteration of change (direction & magnitude)
+ */
+typedef struct MovLayer_s {
+  Layer *layer;
+  Vec2 velocity;
+  struct MovLayer_s *next;
+} MovLayer;
+
+/** Move each layer to its posNext and mark the tiles it left and 
+ *  entered as dirty.  Called by the renderer, not the tick handler.
+ *
+ *  Interrupts stay enabled: the copy is retried if movLayerPublish()
+ *  ran in the middle of it.
+ */
+void movLayerCommit(MovLayer *movLayers);
+
+/** Called by the tick handler after it has written every posNext.
+ *  Bumps movLayerSeq and sets framePending.
+ */
+void movLayerPublish();
+
+/** Count of movLayerPublish() calls (sequence counter)
+ */
+extern volatile u_int movLayerSeq;
+
+/** Keeps the compiler from moving loads and stores across this point
+ *  (movLayerSeq is volatile, the positions it guards are not)
+ */
+#define compilerBarrier() __asm__ volatile ("" ::: "memory")
+
+/** movLayerCommit() followed by frameFlush()
+ */
+void movLayerDraw(MovLayer *movLayers, Layer *layers);
+
+/** Fixed-capacity pool of moving layers
+ *
+ *  Objects are handed out by bumping "fresh" until the pool has been
+ *  used once, and afterwards from a free list threaded through
+ *  MovLayer.next, so alloc and free are O(1) and need no init call.
+ *  used and highWater report current and peak occupancy.
+ */
+typedef struct {
+  MovLayer mov;			/* first: a free object is its MovLayer */
+  Layer layer;
+} PoolObj;
+
+typedef struct {
+  PoolObj *objs;
+  u_char capacity;
+  u_char fresh;			/* objs[fresh..] never allocated */
+  u_char used, highWater;
+  MovLayer *freeList;
+} LayerPool;
+
+/** Define a LayerPool called name with static storage for n objects
+ */
+#define LAYER_POOL(name, n)				\
+  static PoolObj name##Objs[n];				\
+  LayerPool name = { name##Objs, n, 0, 0, 0, 0 }
+
+/** Take an object from the pool.  Its layer is zeroed except that
+ *  mov.layer points to it.
+ *
+ *  \return The object's MovLayer, or 0 if the pool is exhausted
+ */
+MovLayer *layerPoolAlloc(LayerPool *pool);
+
+/** Link an allocated object in after layerAfter and movAfter (which
+ *  stay at fixed positions, so list heads never change).  Set the
+ *  layer's abShape, pos and color and the velocity first.
+ *
+ *  Each list is updated by a single pointer store inside a short
+ *  GIE-off section (GIE is left as the caller had it), so the tick
+ *  handler sees either the old or the new list.  Call from the main
+ *  loop only.
+ */
+void layerPoolSpawn(MovLayer *ml, Layer *layerAfter, MovLayer *movAfter);
+
+/** Unlink an object from both lists, mark its tiles dirty so the
+ *  next flush erases it, and return it to the pool.  Main loop only.
+ *
+ *  \return 0, or -1 (and nothing is changed) if ml is not in the list
+ *  after movLayers or its layer is not in the list after layers
+ */
+int layerPoolDespawn(LayerPool *pool, MovLayer *ml, Layer *layers, MovLayer *movLayers);
+
+/** Dirty tiles
+ *
+ *  The screen is divided into 8x8 tiles, one bit each (40 bytes for
+ *  128x160).  Drawing calls mark tiles; frameFlush() recomposites
+ *  only marked tiles, merged into as few lcd windows as possible.
+ */
+#define TILE_SHIFT 3
+#define TILE_SIZE (1 << TILE_SHIFT)
+#define TILE_COLS ((screenWidth + TILE_SIZE - 1) >> TILE_SHIFT)
+#define TILE_ROWS ((screenHeight + TILE_SIZE - 1) >> TILE_SHIFT)
+
+/** Mark every tile touched by region (inclusive, clipped to screen)
+ */
+void dirtyRegion(const Region *region);
+
+/** Mark the whole screen
+ */
+void dirtyAll();
+
+/** Forget every mark, e.g. after drawing the whole screen
+ */
+void dirtyClear();
+
+/** Mark tiles covered by a layer at its current and last positions
+ */
+void layerMarkDirty(const Layer *l);
+
+/** Recomposite all dirty tiles and clear them.
+ *
+ *  \return Number of pixels redrawn
+ */
+u_int frameFlush(Layer *layers);
+
+/** Like frameFlush, but draws each dirty area with draw(scene, area)
+ */
+u_int dirtyFlush(void (*draw)(void *scene, const Region *area), void *scene);
+
+/** Set (typically by a tick interrupt handler) when layers have new
+ *  posNext values.  The main loop sleeps until it is set and clears
+ *  it before calling movLayerCommit().
+ */
+extern volatile u_char framePending;
+
+/** Tilemap background
+ *
+ *  A Tileset holds 8x8 two-color tiles in flash: 8 bytes of rows
+ *  (bit 0 is the leftmost pixel, as for lcd_expandBits) and a
+ *  {foreground, background} color pair per tile.  A Tilemap places
+ *  cols x rows tiles on the dirty tile grid, so one cell is exactly
+ *  one dirty tile.  Cells are a byte each: a full screen map is 320
+ *  bytes, so keep large maps in flash (and don't tilemapSet them) or
+ *  cover only part of the screen.
+ */
+typedef struct {
+  const u_char (*bits)[TILE_SIZE]; /**< [tiles] rows, bit 0 leftmost */
+  const u_int (*colors)[2];	/**< [tiles] {fg, bg} in BGR */
+} Tileset;
+
+typedef struct {
+  const Tileset *tileset;
+  u_char left, top;		/**< position in tiles */
+  u_char cols, rows;		/**< size in tiles */
+  const u_char *cells;		/**< [rows][cols] tile numbers */
+} Tilemap;
+
+/** When set, the compositors take pixels that no layer covers from
+ *  this map instead of bgColor (bgColor still fills the rest of the
+ *  screen).  Call dirtyAll() after changing it.
+ */
+extern const Tilemap *bgTilemap;
+
+/** Set the cell at col,row (in map tiles) and mark its one tile dirty
+ *
+ *  Only for maps whose cells are in RAM: cells is const so that flash
+ *  maps need no cast, and this casts it away to write the cell.
+ */
+void tilemapSet(const Tilemap *map, u_char col, u_char row, u_char tile);
+
+/** Draw every cell of map directly, one window per tile
+ */
+void tilemapDraw(const Tilemap *map);
+
+/** Compositor cursor over one screen row of the background
+ */
+typedef struct {
+  const u_char *cells;		/**< the map's cells in this row, or 0 */
+  u_char tileRow;		/**< row within those tiles */
+} BgRow;
+
+/** Start a background row cursor for screen row row
+ */
+void bgRowStart(BgRow *bg, int row);
+
+/** Background color at col in bg's row
+ */
+u_int bgRowPixel(const BgRow *bg, int col);
+
+/** A full-screen redraw spread over many short steps
+ *
+ *  Each redrawJobStep() composites the next few rows, so a full
+ *  refresh adds at most one step's time to any frame.  Rows already
+ *  drawn stay correct: later moves are repaired by dirty tiles.
+ */
+typedef struct {
+  u_char row;			/**< next row to draw */
+  u_char active;		/**< rows remain */
+} RedrawJob;
+
+/** (Re)starts job from the top row
+ */
+void redrawJobStart(RedrawJob *job);
+
+/** Draws up to rows more rows of layers
+ *  
+ *  \return nonzero while rows remain
+ */
+int redrawJobStep(RedrawJob *job, Layer *layers, u_char rows);
+
+/** AbShape text in the 5x7 font
+ *
+ *  centerPos is the top-left corner of the first character (as with
+ *  drawString5x7).  Characters are 6 columns apart.  After changing
+ *  string, call layerMarkDirty() on its layer; if the string gets
+ *  shorter, mark it before the change as well.
+ */
+typedef struct AbText_s {
+  void (*getBounds)(const struct AbText_s *text, const Vec2 *centerPos, Region *bounds);
+  int (*check)(const struct AbText_s *text, const Vec2 *centerPos, const Vec2 *pixel);
+  const char *string;
+} AbText;
+
+/** As required by AbShape
+ */
+void abTextGetBounds(const AbText *text, const Vec2 *centerPos, Region *bounds);
+
+/** As required by AbShape
+ */
+int abTextCheck(const AbText *text, const Vec2 *centerPos, const Vec2 *pixel);
+
 #endif
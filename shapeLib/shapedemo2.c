@@ -5,17 +5,47 @@
 
 AbRect rect10 = {abRectGetBounds, abRectCheck, 10,10};
 AbRArrow arrow30 = {abRArrowGetBounds, abRArrowCheck, 30};
+AbTriangle upArrow = {abTriangleGetBounds, abSpanCheck, abTriangleSpan,
+		      {{0,-12}, {10,8}, {-10,8}}};
+const Vec2 hexCorners[] = {{-5,-9}, {5,-9}, {10,0}, {5,9}, {-5,9}, {-10,0}};
+AbConvexPoly hex = {abConvexPolyGetBounds, abSpanCheck, abConvexPolySpan,
+		    6, hexCorners};
+
+static const u_char wallBits[][TILE_SIZE] = {
+  {0xff, 0x01, 0x01, 0x01, 0xff, 0x10, 0x10, 0x10}, /* brick */
+  {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, /* gap */
+};
+static const u_int wallColors[][2] = {
+  {COLOR_GRAY, COLOR_FIREBRICK}, {COLOR_BLACK, COLOR_BLUE}
+};
+const Tileset wallTiles = {wallBits, wallColors};
+static u_char wallCells[3][16];	/**< all bricks (tile 0) */
+Tilemap wall = {&wallTiles, 0, 16, 16, 3, &wallCells[0][0]}; /**< 3 rows at y = 128 */
 
 
 Region fence = {{10,30}, {SHORT_EDGE_PIXELS-10, LONG_EDGE_PIXELS-10}};
 
 
+Layer layer4 = {
+  (AbShape *)&hex,
+  {screenWidth/2-30, screenHeight/2-40}, 	    /* position */
+  {0,0}, {0,0},				    /* last & next pos */
+  COLOR_YELLOW,
+  0,
+};
+Layer layer3 = {
+  (AbShape *)&upArrow,
+  {screenWidth/2-30, screenHeight/2+40}, 	    /* position */
+  {0,0}, {0,0},				    /* last & next pos */
+  COLOR_GREEN,
+  &layer4,
+};
 Layer layer2 = {
   (AbShape *)&arrow30,
   {screenWidth/2+40, screenHeight/2+10}, 	    /* position */
   {0,0}, {0,0},				    /* last & next pos */
   COLOR_BLACK,
-  0,
+  &layer3,
 };
 Layer layer1 = {
   (AbShape *)&rect10,
@@ -48,7 +78,11 @@ main()
   shapeInit();
   
   layerInit(&layer0);
+  bgTilemap = &wall;		/* background: bgColor plus the wall */
   layerDraw(&layer0);
+
+  tilemapSet(&wall, 7, 1, 1);	/* knock out a brick: */
+  frameFlush(&layer0);		/* redraws just that 8x8 tile */
   
 }
 
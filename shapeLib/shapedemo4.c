@@ -0,0 +1,109 @@
+/** \file shapedemo4.c
+ *  \brief shapedemo3's sliced rectangle built from AbCsg shapes
+ *
+ *  The left rect uses shapedemo3's hand-written check; the right one
+ *  is the same rect minus a polygon (CSG_DIFFERENCE), drawn a run at
+ *  a time.  Below them is a HUD frame: a rect minus a smaller rect,
+ *  joined with a gauge clipped to a hexagon.  The time to draw each
+ *  (Timer1_A, 4us ticks) is shown below it in us.
+ */
+#include <libTimer.h>
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "shape.h"
+
+// like abRectCheck, but excludes a triangle (as in shapedemo3)
+int
+abSlicedRectCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  Vec2 relPos;
+  vec2Sub(&relPos, pixel, centerPos); /* vector from center to pixel */
+  if (relPos.axes[0] >= 0 && relPos.axes[0]/2 < relPos.axes[1])
+    return 0;
+  else
+    return abRectCheck(rect, centerPos, pixel);
+}
+
+AbRect slicedRect = {abRectGetBounds, abSlicedRectCheck, {20,20}};
+
+AbRect rect20 = {abRectGetBounds, abRectCheck, {20,20}};
+const Vec2 sliceCorners[] = {{0,1}, {1,1}, {41,21}, {0,21}}; /* x >= 0, y > x/2 */
+AbConvexPoly slice = {abConvexPolyGetBounds, abSpanCheck, abConvexPolySpan,
+		      4, sliceCorners};
+SpanWalk sliceWalks[2];
+AbCsg slicedCsg = {abCsgGetBounds, abSpanCheck, abCsgSpan, CSG_DIFFERENCE,
+		   (AbShape *)&rect20, {0,0}, (AbShape *)&slice, {0,0}, sliceWalks};
+
+AbRect frameOuter = {abRectGetBounds, abRectCheck, {50,14}};
+AbRect frameInner = {abRectGetBounds, abRectCheck, {48,12}};
+AbCsg frame = {abCsgGetBounds, abSpanCheck, abCsgSpan, CSG_DIFFERENCE,
+	       (AbShape *)&frameOuter, {0,0}, (AbShape *)&frameInner, {0,0}};
+const Vec2 hexCorners[] = {{-10,-9}, {10,-9}, {20,0}, {10,9}, {-10,9}, {-20,0}};
+AbConvexPoly hex = {abConvexPolyGetBounds, abSpanCheck, abConvexPolySpan,
+		    6, hexCorners};
+AbRect gaugeLevel = {abRectGetBounds, abRectCheck, {14,9}};
+SpanWalk gaugeWalks[2];
+AbCsg gauge = {abCsgGetBounds, abSpanCheck, abCsgSpan, CSG_INTERSECT, /* 70% full */
+	       (AbShape *)&hex, {0,0}, (AbShape *)&gaugeLevel, {-6,0}, gaugeWalks};
+AbCsg hud = {abCsgGetBounds, abSpanCheck, abCsgSpan, CSG_UNION,
+	     (AbShape *)&frame, {0,0}, (AbShape *)&gauge, {24,0}};
+
+Layer hudLayer = {
+  (AbShape *)&hud,
+  {screenWidth/2, screenHeight/2+40},	    /* position */
+  {0,0}, {0,0},				    /* last & next pos */
+  COLOR_GREEN,
+  0,
+};
+Layer csgLayer = {
+  (AbShape *)&slicedCsg,
+  {screenWidth/2+30, screenHeight/2-30},   /* position */
+  {0,0}, {0,0},				    /* last & next pos */
+  COLOR_ORANGE,
+  &hudLayer,
+};
+Layer checkLayer = {
+  (AbShape *)&slicedRect,
+  {screenWidth/2-30, screenHeight/2-30},   /* position */
+  {0,0}, {0,0},				    /* last & next pos */
+  COLOR_RED,
+  &csgLayer,
+};
+
+u_int bgColor = COLOR_BLUE;
+
+/** Draws l's shape alone and shows the time taken below it */
+static void
+drawTimed(Layer *l)
+{
+  Layer *next = l->next;
+  Region bounds;
+  u_int start, ticks;
+  char buf[6];
+
+  l->next = 0;
+  abShapeGetBounds(l->abShape, &l->pos, &bounds);
+  start = timeNow16();
+  layerDrawRegion(l, &bounds);
+  ticks = timeElapsed16(start);
+  l->next = next;
+  *putDecimal(buf, ticks * 4, 0, 0) = 0;
+  drawString5x7(bounds.topLeft.axes[0], bounds.botRight.axes[1] + 4,
+		buf, COLOR_WHITE, bgColor);
+}
+
+int
+main()
+{
+  configureClocks();
+  timeInit();
+  lcd_init();
+  shapeInit();
+
+  clearScreen(bgColor);
+  drawString5x7(10, 10, "check vs CSG (us)", COLOR_WHITE, bgColor);
+  layerInit(&checkLayer);
+  drawTimed(&checkLayer);
+  drawTimed(&csgLayer);
+  drawTimed(&hudLayer);
+}
@@ -0,0 +1,30 @@
+#include "lcdutils.h"
+#include "shape.h"
+
+void
+abTextGetBounds(const AbText *text, const Vec2 *centerPos, Region *bounds)
+{
+  const char *s;
+  int width = 0;
+  for (s = text->string; *s; s++)
+    width += 6;
+  bounds->topLeft = *centerPos;
+  bounds->botRight.axes[0] = centerPos->axes[0] + (width ? width - 2 : 0);
+  bounds->botRight.axes[1] = centerPos->axes[1] + 7;
+}
+
+// true if pixel is part of a glyph
+int
+abTextCheck(const AbText *text, const Vec2 *centerPos, const Vec2 *pixel)
+{
+  int col = pixel->axes[0] - centerPos->axes[0];
+  int row = pixel->axes[1] - centerPos->axes[1];
+  const char *s = text->string;
+  if (col < 0 || row < 0 || row > 7)
+    return 0;
+  for (; *s && col >= 6; s++)	/* find the character */
+    col -= 6;
+  if (!*s || col == 5)		/* past the end, or the gap */
+    return 0;
+  return (font_5x7[*s - 0x20][col] >> row) & 1;
+}
@@ -0,0 +1,67 @@
+#include "lcdutils.h"
+#include "lcdblit.h"
+#include "shape.h"
+
+const Tilemap *bgTilemap;	/* none: plain bgColor */
+
+void
+tilemapSet(const Tilemap *map, u_char col, u_char row, u_char tile)
+{
+  Region cell;
+  ((u_char *)map->cells)[row * map->cols + col] = tile; /* a RAM map (see shape.h) */
+  cell.topLeft.axes[0] = (map->left + col) << TILE_SHIFT;
+  cell.topLeft.axes[1] = (map->top + row) << TILE_SHIFT;
+  cell.botRight.axes[0] = cell.topLeft.axes[0] + TILE_SIZE - 1;
+  cell.botRight.axes[1] = cell.topLeft.axes[1] + TILE_SIZE - 1;
+  dirtyRegion(&cell);
+}
+
+void
+tilemapDraw(const Tilemap *map)
+{
+  const Tileset *set = map->tileset;
+  const u_char *cell = map->cells;
+  u_char row, col, i;
+  for (row = 0; row < map->rows; row++) {
+    for (col = 0; col < map->cols; col++) {
+      u_char tile = *cell++;
+      u_char x = (map->left + col) << TILE_SHIFT, y = (map->top + row) << TILE_SHIFT;
+      lcd_setArea(x, y, x + TILE_SIZE - 1, y + TILE_SIZE - 1);
+      for (i = 0; i < TILE_SIZE; i++)
+	lcd_expandBits(set->bits[tile][i], TILE_SIZE, set->colors[tile][0], set->colors[tile][1]);
+    }
+  }
+}
+
+void
+bgRowStart(BgRow *bg, int row)
+{
+  const Tilemap *map = bgTilemap;
+  u_int mapRow;
+  bg->cells = 0;
+  if (!map)
+    return;
+  mapRow = (row >> TILE_SHIFT) - map->top; /* wraps if above the map */
+  if (mapRow < map->rows) {
+    bg->cells = map->cells + mapRow * map->cols;
+    bg->tileRow = row & (TILE_SIZE - 1);
+  }
+}
+
+u_int
+bgRowPixel(const BgRow *bg, int col)
+{
+  const Tilemap *map = bgTilemap;
+  const Tileset *set;
+  u_int mapCol;
+  u_char tile, bit;
+  if (!bg->cells)
+    return bgColor;
+  mapCol = (col >> TILE_SHIFT) - map->left;
+  if (mapCol >= map->cols)
+    return bgColor;
+  set = map->tileset;
+  tile = bg->cells[mapCol];
+  bit = (set->bits[tile][bg->tileRow] >> (col & (TILE_SIZE - 1))) & 1;
+  return set->colors[tile][!bit];
+}
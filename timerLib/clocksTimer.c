@@ -1,6 +1,9 @@
 #include <msp430.h>
 #include "libTimer.h"
 
+unsigned char clockSpeed = CLOCK_FAST, clockSmclkShift = 0;
+static unsigned char spiFastBr;	/* UCB0BR0 at CLOCK_FAST, kept while slow */
+
 void configureClocks(){
   WDTCTL = WDTPW + WDTHOLD;//Disable Watchdog Timer
   BCSCTL1 = CALBC1_16MHZ;  // Set DCO to 16 Mhz
@@ -8,11 +11,73 @@ void configureClocks(){
     
   BCSCTL2 &= ~(SELS);     // SMCLK source = DCO
   BCSCTL2 |= DIVS_3;      // SMCLK = DCO / 8
+  clockSpeed = CLOCK_FAST;
+  clockSmclkShift = 0;
 }
 
+/* Timer1_A is stopped while SMCLK and its divider change, and its
+ * prescaler is not cleared, so a switch loses at most a tick or two.
+ * Only MC and ID are changed, with bic/bis on the live register, so an
+ * overflow's TAIFG is never written back stale.  SMCLK is divided
+ * before the DCO speeds up, and after it slows down, so it never
+ * exceeds 2MHz.  Timer0_A (the buzzer) is stopped too, and its count
+ * scaled with its compare registers, so it never starts past CCR0.
+ * USCI_B0 is held in reset, after its last byte is out, while its
+ * divider is halved or given back.
+ */
+void clockSetSpeed(unsigned char speed)
+{
+  unsigned int sr, ta1mc, ta0mc;
+  unsigned char spiRun;
+  if (speed == clockSpeed)
+    return;
+  sr = get_sr();
+  and_sr(~8);
+  powerSpeedChange();		/* charge the time so far at the old speed */
+  ta1mc = TA1CTL & MC_3;
+  ta0mc = TA0CTL & MC_3;
+  TA1CTL &= ~MC_3;		/* stop Timer1_A */
+  TA0CTL &= ~MC_3;		/* and Timer0_A */
+  TA1CTL &= ~ID_3;
+  while (UCB0STAT & UCBUSY)	/* let the last LCD byte out */
+    ;
+  spiRun = !(UCB0CTL1 & UCSWRST);
+  UCB0CTL1 |= UCSWRST;
+  if (speed == CLOCK_FAST) {
+    BCSCTL2 |= DIVS_3;		/* SMCLK = DCO / 8 */
+    DCOCTL = 0;			/* lowest setting while RSEL changes */
+    BCSCTL1 = CALBC1_16MHZ;
+    DCOCTL = CALDCO_16MHZ;
+    TA1CTL |= ID_3;		/* 2MHz / 8 */
+    TA0CCR0 <<= 1;		/* same tone at twice the clock */
+    TA0CCR1 <<= 1;
+    TA0R <<= 1;
+    UCB0BR0 = spiFastBr;
+    clockSmclkShift = 0;
+  } else {
+    DCOCTL = 0;
+    BCSCTL1 = CALBC1_1MHZ;
+    DCOCTL = CALDCO_1MHZ;
+    BCSCTL2 &= ~DIVS_3;		/* SMCLK = DCO */
+    TA1CTL |= ID_2;		/* 1MHz / 4 */
+    TA0CCR0 >>= 1;
+    TA0CCR1 >>= 1;
+    TA0R >>= 1;			/* still at or below CCR0 */
+    spiFastBr = UCB0BR0;
+    UCB0BR0 = (spiFastBr > 1) ? spiFastBr >> 1 : 1; /* 1 is already SMCLK */
+    clockSmclkShift = 1;
+  }
+  if (spiRun)
+    UCB0CTL1 &= ~UCSWRST;
+  TA0CTL |= ta0mc;
+  TA1CTL |= ta1mc;		/* restart */
+  clockSpeed = speed;
+  if (sr & 8)
+    or_sr(8);
+}
 
 // enable watchdog timer periodic interrupt
-// period = SMCLOCK/32k
+// period = 8192 SMCLK cycles (see wdtIntervals())
 void enableWDTInterrupts()  
 {
   WDTCTL = WDTPW |	   // passwd req'd.  Otherwise device resets
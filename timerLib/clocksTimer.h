@@ -5,4 +5,27 @@ void configureClocks();
 void enableWDTInterrupts();
 void timerAUpmode();
 
+/* Clock speeds for clockSetSpeed() */
+#define CLOCK_FAST 0		/* DCO 16MHz, SMCLK = DCO/8 = 2MHz */
+#define CLOCK_SLOW 1		/* DCO 1MHz, SMCLK = DCO = 1MHz */
+
+/* Switches the DCO between its 16MHz and 1MHz calibrations.  Timer1_A
+ * (timeBase) keeps its 4us tick, Timer_A0 compare registers are
+ * rescaled so tones keep their pitch, and USCI_B0's divider (the LCD's
+ * SPI) is halved while slow, so the bit rate holds unless it is already
+ * SMCLK (divider 1, lcdLib's setting).  The watchdog has no divider a
+ * factor of two apart: see wdtIntervals().
+ */
+void clockSetSpeed(unsigned char speed);
+
+extern unsigned char clockSpeed;
+
+/* SMCLK cycles at 2MHz >> clockSmclkShift = cycles at the current SMCLK */
+extern unsigned char clockSmclkShift;
+
+/* Intervals of enableWDTInterrupts() at 2MHz (4.1ms) that one watchdog
+ * interrupt stands for: 1, or 2 while slow.  Count time with it.
+ */
+#define wdtIntervals() (1 << clockSmclkShift)
+
 #endif
@@ -3,5 +3,8 @@
 
 #include "clocksTimer.h"
 #include "sr.h"
+#include "timeBase.h"
+#include "softTimer.h"
+#include "power.h"
 
 #endif // included
@@ -0,0 +1,45 @@
+#include <msp430.h>
+#include "libTimer.h"
+
+static unsigned char smclkHolds, aclkHolds;
+
+void
+powerRequire(unsigned char clocks)
+{
+  unsigned int sr = get_sr();
+  and_sr(~8);
+  if (clocks & POWER_SMCLK) smclkHolds++;
+  if (clocks & POWER_ACLK) aclkHolds++;
+  if (sr & 8) or_sr(8);
+}
+
+void
+powerRelease(unsigned char clocks)
+{
+  unsigned int sr = get_sr();
+  and_sr(~8);
+  if (clocks & POWER_SMCLK) smclkHolds--;
+  if (clocks & POWER_ACLK) aclkHolds--;
+  if (sr & 8) or_sr(8);
+}
+
+void
+powerSleep()
+{
+  unsigned int bits;
+  unsigned char mode;
+  and_sr(~8);
+  if (smclkHolds || softTimerPending()) {
+    bits = LPM1_bits;		/* Timer1_A runs on SMCLK */
+    mode = POWER_LPM1;
+  } else if (aclkHolds) {
+    bits = LPM3_bits;
+    mode = POWER_LPM3;
+  } else {
+    bits = LPM4_bits;
+    mode = POWER_LPM4;
+  }
+  powerSleepBegin(mode);
+  or_sr(bits | GIE);		/* enable and sleep in one instruction */
+  powerSleepEnd();
+}
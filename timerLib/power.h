@@ -0,0 +1,36 @@
+#ifndef power_included
+#define power_included
+
+#include "sr.h"
+#include "powerStats.h"
+
+/* Clocks a peripheral needs while the CPU sleeps */
+#define POWER_SMCLK 1		/* e.g. a Timer_A or USCI on SMCLK */
+#define POWER_ACLK 2		/* e.g. a Timer_A on ACLK */
+
+void powerRequire(unsigned char clocks);
+void powerRelease(unsigned char clocks);
+
+/* Sleeps in the deepest mode the holds and pending soft timers allow:
+ * LPM1 if SMCLK is needed, LPM3 if only ACLK, else LPM4 (until a port
+ * interrupt).  Interrupts are enabled by the same instruction that
+ * sleeps, so it may be called with them off.  Returns, with interrupts
+ * on, after an interrupt wakes the CPU.
+ */
+void powerSleep();
+
+/* Sleeps until cond (an expression on flags that interrupts set) is
+ * true.  cond is tested with interrupts off, so an interrupt that sets
+ * a flag just after the test still wakes the sleep that follows it.
+ * Returns with interrupts on.
+ */
+#define powerSleepUntil(cond) do {		\
+    and_sr(~8);					\
+    while (!(cond)) {				\
+      powerSleep();				\
+      and_sr(~8);				\
+    }						\
+    or_sr(8);					\
+  } while (0)
+
+#endif
@@ -0,0 +1,147 @@
+#include <msp430.h>
+#include "libTimer.h"
+
+#ifdef POWER_STATS
+
+/* Typical MSP430G2553 supply currents at 3V in uA (SLAS735), at the
+ * 16MHz and 1MHz clock speeds.  Active at 16MHz is scaled from the
+ * per-MHz figure; LPM1 with the DCO left running for SMCLK is not
+ * tabulated and is a rough estimate.  Define these to measured values
+ * where known.  The LCD, its backlight and the buzzer are not included.
+ */
+#ifndef POWER_UA_ACTIVE
+#define POWER_UA_ACTIVE 4200
+#endif
+#ifndef POWER_UA_LPM1
+#define POWER_UA_LPM1 400
+#endif
+#ifndef POWER_UA_ACTIVE_SLOW
+#define POWER_UA_ACTIVE_SLOW 300
+#endif
+#ifndef POWER_UA_LPM1_SLOW
+#define POWER_UA_LPM1_SLOW 60
+#endif
+#ifndef POWER_UA_LPM3
+#define POWER_UA_LPM3 1
+#endif
+#ifndef POWER_UA_LPM4
+#define POWER_UA_LPM4 1
+#endif
+#define POWER_VOLTS 3
+
+PowerCount powerCounts[POWER_CAUSES];
+unsigned long powerSleepTicks[POWER_MODES];
+
+static volatile unsigned char asleep; /* mode + 1 while asleep, else 0 */
+static unsigned long sleepStart, awakeSince;
+static unsigned int isrTicks;	/* by handlers during this sleep */
+
+#ifdef POWER_TRACE
+PowerTrace powerTrace[POWER_TRACE_SIZE];
+unsigned char powerTraceNext;
+
+static void
+trace(unsigned char event)
+{
+  powerTrace[powerTraceNext].time = TA1R;
+  powerTrace[powerTraceNext].event = event;
+  powerTraceNext = (powerTraceNext + 1) & (POWER_TRACE_SIZE - 1);
+}
+#else
+# define trace(event)
+#endif
+
+/* interrupts are off */
+void
+powerSleepBegin(unsigned char mode)
+{
+  unsigned long now = timeNow();
+  powerCounts[POWER_MAIN].ticks += now - awakeSince;
+  trace(POWER_TRACE_SLEEP + mode);
+  sleepStart = now;
+  isrTicks = 0;
+  asleep = mode + 1;
+}
+
+void
+powerSleepEnd()
+{
+  unsigned char mode;
+  and_sr(~8);
+  mode = asleep - 1;
+  asleep = 0;
+  awakeSince = timeNow();
+  powerSleepTicks[mode] += awakeSince - sleepStart - isrTicks;
+  powerCounts[POWER_MAIN].count++;
+  or_sr(8);
+}
+
+void
+powerInterrupt(unsigned char cause, unsigned int start)
+{
+  powerCounts[cause].count++;
+  if (asleep) {			/* else the main loop's time */
+    unsigned int ticks = TA1R - start;
+    powerCounts[cause].ticks += ticks;
+    isrTicks += ticks;
+    trace(cause);
+  }
+}
+
+/* ticks * 4us * uA * V, in nJ */
+static unsigned long
+nanojoules(unsigned long ticks, unsigned int microamps)
+{
+  return ticks * microamps / 1000 * (4 * POWER_VOLTS);
+}
+
+static const unsigned int microamps[2][1 + POWER_MODES] = {
+  /* awake, LPM1, LPM3, LPM4 */
+  {POWER_UA_ACTIVE, POWER_UA_LPM1, POWER_UA_LPM3, POWER_UA_LPM4}, /* CLOCK_FAST */
+  {POWER_UA_ACTIVE_SLOW, POWER_UA_LPM1_SLOW, POWER_UA_LPM3, POWER_UA_LPM4},
+};
+
+static unsigned long energy;	/* nJ not yet returned by powerFrame() */
+
+/* Charges the ticks counted since the last call at clockSpeed's
+ * currents.  Interrupts are off and the main loop is awake.
+ */
+static void
+charge()
+{
+  static unsigned long lastActive, lastSleep[POWER_MODES];
+  const unsigned int *ua = microamps[clockSpeed];
+  unsigned long active = 0, now = timeNow();
+  unsigned char i;
+  powerCounts[POWER_MAIN].ticks += now - awakeSince;
+  awakeSince = now;
+  for (i = 0; i < POWER_CAUSES; i++)
+    active += powerCounts[i].ticks;
+  energy += nanojoules(active - lastActive, ua[0]);
+  lastActive = active;
+  for (i = 0; i < POWER_MODES; i++) {
+    energy += nanojoules(powerSleepTicks[i] - lastSleep[i], ua[1 + i]);
+    lastSleep[i] = powerSleepTicks[i];
+  }
+}
+
+void
+powerSpeedChange()
+{
+  charge();
+}
+
+unsigned long
+powerFrame()
+{
+  unsigned long nj;
+  unsigned int sr = get_sr();
+  and_sr(~8);
+  charge();
+  nj = energy;
+  energy = 0;
+  if (sr & 8) or_sr(8);
+  return nj;
+}
+
+#endif // POWER_STATS
@@ -0,0 +1,69 @@
+#ifndef powerStats_included
+#define powerStats_included
+
+/* Who kept the CPU awake; index into powerCounts */
+#define POWER_MAIN 0		/* main loop, between powerSleep()s */
+#define POWER_TIMER 1		/* soft timer callbacks (TA1CCR0) */
+#define POWER_TIME 2		/* Timer1_A overflow (timeBase) */
+#define POWER_CAUSES 3
+
+/* Sleep modes powerSleep() picks, index into powerSleepTicks */
+#define POWER_LPM1 0
+#define POWER_LPM3 1
+#define POWER_LPM4 2
+#define POWER_MODES 3
+
+#ifdef POWER_STATS		/* timerLib built with "make STATS=1" */
+
+typedef struct {
+  unsigned long count;		/* interrupts (main loop: wakeups) */
+  unsigned long ticks;		/* Timer1_A ticks awake */
+} PowerCount;
+
+/* Totals since reset.  Interrupts that preempt the main loop are
+ * counted but their time is the main loop's.  Timer1_A stops in LPM4,
+ * so time asleep there is not seen.  Read with interrupts off.
+ */
+extern PowerCount powerCounts[POWER_CAUSES];
+extern unsigned long powerSleepTicks[POWER_MODES];
+
+/* Call at the end of an interrupt handler, with TA1R from its entry */
+void powerInterrupt(unsigned char cause, unsigned int start);
+
+/* Estimated MCU energy since the last call, in nJ, from datasheet
+ * currents at each clock speed (see powerStats.c).  Call once per frame.  Frames over ~4s
+ * overflow.
+ */
+unsigned long powerFrame();
+
+/* Called by clockSetSpeed() before the clock changes */
+void powerSpeedChange();
+
+/* Used by powerSleep() */
+void powerSleepBegin(unsigned char mode);
+void powerSleepEnd();
+
+#ifdef POWER_TRACE
+/* The last POWER_TRACE_SIZE sleeps and wakeups, oldest first at
+ * powerTraceNext.  event is a cause, or POWER_TRACE_SLEEP + a mode.
+ */
+#define POWER_TRACE_SIZE 8
+#define POWER_TRACE_SLEEP 0x10
+typedef struct {
+  unsigned int time;		/* TA1R */
+  unsigned char event;
+} PowerTrace;
+extern PowerTrace powerTrace[POWER_TRACE_SIZE];
+extern unsigned char powerTraceNext;
+#endif
+
+#else  /* no accounting: the hooks compile away */
+
+static inline void powerInterrupt(unsigned char cause, unsigned int start) {}
+static inline void powerSpeedChange() {}
+static inline void powerSleepBegin(unsigned char mode) {}
+static inline void powerSleepEnd() {}
+
+#endif // POWER_STATS
+
+#endif
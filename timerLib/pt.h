@@ -0,0 +1,78 @@
+#ifndef pt_included
+#define pt_included
+
+#include "timeBase.h"
+
+/* Protothreads: stackless coroutines for the main loop.
+ *
+ * A task is a function that takes its Pt and is called over and over
+ * (e.g. once per main loop pass).  Between PT_BEGIN and PT_END it may
+ * wait; each wait returns PT_WAITING to the caller and the next call
+ * resumes there, through a switch on the line number saved in the Pt.
+ * So a task costs six bytes of state and no stack of its own, but its
+ * local variables are lost at every wait (make them static) and it
+ * can't use switch statements of its own around a wait.
+ *
+ *   static int blink(Pt *pt) {
+ *     PT_BEGIN(pt);
+ *     for (;;) {
+ *       P1OUT ^= BIT0;
+ *       PT_WAIT_TICKS(pt, TIME_MS(500));
+ *     }
+ *     PT_END(pt);
+ *   }
+ *
+ * Waits are polled: they can only end when the task is called, so
+ * PT_WAIT_TICKS is as coarse as the loop that calls it.
+ */
+typedef struct {
+  unsigned int lc;		/* line to resume at, 0 to start over */
+  unsigned long wake;		/* PT_WAIT_TICKS deadline */
+} Pt;
+
+#define PT_WAITING 0
+#define PT_ENDED 1
+
+#define PT_INIT(pt) ((pt)->lc = 0)
+
+#define PT_BEGIN(pt) switch ((pt)->lc) { case 0:
+
+#define PT_END(pt) } (pt)->lc = 0; return PT_ENDED
+
+/* Waits while cond is false */
+#define PT_WAIT_UNTIL(pt, cond)			\
+  do {						\
+    (pt)->lc = __LINE__; case __LINE__:		\
+    if (!(cond))				\
+      return PT_WAITING;			\
+  } while (0)
+
+/* Gives the other tasks a turn */
+#define PT_YIELD(pt)				\
+  do {						\
+    (pt)->lc = __LINE__;			\
+    return PT_WAITING;				\
+    case __LINE__:;				\
+  } while (0)
+
+/* Waits ticks of the time base (TIME_MS(), TIME_US()) */
+#define PT_WAIT_TICKS(pt, ticks)			\
+  do {							\
+    (pt)->wake = timeDeadline(ticks);			\
+    PT_WAIT_UNTIL(pt, timeReached((pt)->wake));		\
+  } while (0)
+
+/* Waits for any of the bits in mask to be set in events (a byte or
+ * word written by interrupts or other tasks).  The bits are left set:
+ * the task clears those it consumed.
+ */
+#define PT_WAIT_EVENT(pt, events, mask) PT_WAIT_UNTIL(pt, (events) & (mask))
+
+/* Ends the task; the next call starts it from PT_BEGIN */
+#define PT_RESTART(pt)				\
+  do {						\
+    PT_INIT(pt);				\
+    return PT_WAITING;				\
+  } while (0)
+
+#endif
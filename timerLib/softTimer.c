@@ -0,0 +1,136 @@
+#include <msp430.h>
+#include "libTimer.h"
+
+/* a deadline closer than this when programmed is run at once (256 cycles) */
+#define SOFT_TIMER_MARGIN 4
+
+static SoftTimer *head;		/* sorted by deadline */
+
+static unsigned int
+lockIrq()
+{
+  unsigned int sr = get_sr();
+  and_sr(~8);
+  return sr;
+}
+
+static void
+unlockIrq(unsigned int sr)
+{
+  if (sr & 8)			/* only if they were on: may be in an isr */
+    or_sr(8);
+}
+
+static void
+insert(SoftTimer *t)
+{
+  SoftTimer **p = &head;
+  while (*p && (long)((*p)->deadline - t->deadline) <= 0)
+    p = &(*p)->next;		/* after equal deadlines: fifo */
+  t->next = *p;
+  *p = t;
+  t->active = 1;
+}
+
+static void
+unlink(SoftTimer *t)
+{
+  SoftTimer **p;
+  for (p = &head; *p; p = &(*p)->next)
+    if (*p == t) {
+      *p = t->next;
+      break;
+    }
+  t->active = 0;
+}
+
+/* Only the soonest deadline is in the compare register.  Its low word
+ * matches once per overflow, so a deadline more than 262ms off costs
+ * a spurious interrupt every 262ms until it is near.
+ */
+static void
+program()
+{
+  if (!head) {
+    TA1CCTL0 = 0;
+    return;
+  }
+  TA1CCR0 = (unsigned int)head->deadline;
+  TA1CCTL0 = CCIE;
+  if ((long)(head->deadline - timeNow()) < SOFT_TIMER_MARGIN)
+    TA1CCTL0 |= CCIFG;		/* may have passed while we set it */
+}
+
+void
+softTimerStart(SoftTimer *t, unsigned long delay, unsigned long period)
+{
+  unsigned int sr = lockIrq();
+  if (t->active)
+    unlink(t);
+  t->deadline = timeNow() + delay;
+  t->period = period;
+  insert(t);
+  program();
+  unlockIrq(sr);
+}
+
+void
+softTimerStop(SoftTimer *t)
+{
+  unsigned int sr = lockIrq();
+  if (t->active) {
+    unlink(t);
+    program();
+  }
+  unlockIrq(sr);
+}
+
+int
+softTimerPending()
+{
+  return head != 0;
+}
+
+static volatile unsigned char delayDone;
+
+static int
+delayExpired(SoftTimer *t)
+{
+  delayDone = 1;
+  return 1;
+}
+
+void
+timeDelay(unsigned long ticks)
+{
+  SoftTimer delay = {0, 0, delayExpired};
+  delayDone = 0;
+  softTimerStart(&delay, ticks, 0);
+  powerSleepUntil(delayDone);
+}
+
+/* Periodic timers are rescheduled before fn runs, so fn may stop or
+ * restart its own timer.  A late periodic timer runs once per missed
+ * period.
+ */
+void
+__interrupt_vec(TIMER1_A0_VECTOR) Timer1_A0()
+{
+  unsigned int start = TA1R;
+  unsigned long now = timeNow();
+  int wake = 0;
+  while (head && (long)(head->deadline - now) <= 0) {
+    SoftTimer *t = head;
+    head = t->next;
+    t->active = 0;
+    if (t->period) {
+      t->deadline += t->period;
+      insert(t);
+    }
+    wake |= t->fn(t);
+  }
+  program();
+  powerInterrupt(POWER_TIMER, start);
+  if (wake)
+    __bic_SR_register_on_exit(LPM4_bits);
+}
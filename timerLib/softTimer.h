@@ -0,0 +1,23 @@
+#ifndef softTimer_included
+#define softTimer_included
+
+#include "timeBase.h"
+
+/** A one-shot or periodic software timer on Timer1_A (see timeBase.h).
+ *  fn runs in the timer interrupt, with interrupts off; if it returns
+ *  nonzero the CPU is left awake when the interrupt returns.
+ */
+typedef struct SoftTimer_s {
+  unsigned long deadline;	/**< timeNow() at which fn runs next */
+  unsigned long period;		/**< ticks between runs, 0 for one-shot */
+  int (*fn)(struct SoftTimer_s *t);
+  struct SoftTimer_s *next;	/**< pending timers, soonest first */
+  unsigned char active;
+} SoftTimer;
+
+/* (Re)starts t delay ticks from now.  Callable from interrupts. */
+void softTimerStart(SoftTimer *t, unsigned long delay, unsigned long period);
+void softTimerStop(SoftTimer *t);
+int softTimerPending();
+
+#endif
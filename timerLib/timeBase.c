@@ -0,0 +1,37 @@
+#include <msp430.h>
+#include "libTimer.h"
+
+static volatile unsigned int timeHigh; /* Timer1_A overflows */
+
+void
+timeInit()
+{
+  timeHigh = 0;
+  TA1CTL = TASSEL_2 | (clockSpeed == CLOCK_FAST ? ID_3 : ID_2) |
+    MC_2 | TACLR | TAIE;	/* 250kHz, continuous */
+}
+
+/* An overflow may be pending but not yet counted, either because
+ * interrupts are off or because it happened after timeHigh was read;
+ * TAIFG with a small count means the count has already wrapped.
+ */
+unsigned long
+timeNow()
+{
+  unsigned int high, low, wrapped;
+  do {
+    high = timeHigh;
+    low = TA1R;
+    wrapped = (TA1CTL & TAIFG) && !(low & 0x8000);
+  } while (high != timeHigh);	/* overflow handled while we looked */
+  return ((unsigned long)(high + wrapped) << 16) | low;
+}
+
+void
+__interrupt_vec(TIMER1_A1_VECTOR) Timer1_A1()
+{
+  unsigned int start = TA1R;
+  if (TA1IV == TA1IV_TAIFG)	/* reading TA1IV clears TAIFG */
+    timeHigh++;
+  powerInterrupt(POWER_TIME, start);
+}
@@ -0,0 +1,60 @@
+#ifndef timeBase_included
+#define timeBase_included
+
+#include "msp430.h"
+
+/* Timer1_A runs continuously at 250kHz (4us per tick) and its
+ * overflows extend it to 32 bits (~4.8 hours before wrapping).
+ * Time stops while SMCLK is off (LPM4).
+ */
+#define TIME_TICKS_PER_SEC 250000L
+#define TIME_US(us) ((us) / 4L)	/* microseconds to ticks */
+#define TIME_MS(ms) ((ms) * 250L)	/* milliseconds to ticks */
+
+void timeInit();
+unsigned long timeNow();
+
+/* Sleeps (see powerSleep()) for at least ticks.  Main loop only:
+ * other wakeups are slept through.
+ */
+void timeDelay(unsigned long ticks);
+
+/* Ticks since a timeNow() */
+static inline unsigned long
+timeElapsed(unsigned long since)
+{
+  return timeNow() - since;
+}
+
+/* A deadline delay ticks from now, for timeReached() */
+static inline unsigned long
+timeDeadline(unsigned long delay)
+{
+  return timeNow() + delay;
+}
+
+/* Nonzero once deadline has passed; correct across wraparound for
+ * deadlines within ~2.4 hours
+ */
+static inline int
+timeReached(unsigned long deadline)
+{
+  return (long)(timeNow() - deadline) >= 0;
+}
+
+/* The low 16 bits, a single register read, for timing code paths
+ * shorter than 262ms: timeElapsed16(start) after start = timeNow16()
+ */
+static inline unsigned int
+timeNow16()
+{
+  return TA1R;
+}
+
+static inline unsigned int
+timeElapsed16(unsigned int start)
+{
+  return TA1R - start;
+}
+
+#endif